@@ -0,0 +1,539 @@
+#include "graph.h"
+#include "bitset.h"
+#include "walk.h"
+#include "relabel.h"
+#include "wavefront.h"
+#include "shard.h"
+#include "external.h"
+#include "checkpoint.h"
+#include "witness.h"
+#include "batch.h"
+#include "cache.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+int batch_threads = BATCH_AUTO;
+
+/**
+ * @brief Monotonic time in seconds
+ */
+double batch_clock(void) {
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+int batch_compare(const void* first, const void* second) {
+	return strcmp(*(char* const*) first, *(char* const*) second);
+}
+
+/**
+ * @brief Appends a copy of a path to a growing list
+ */
+void batch_append(char*** paths, int* amount, int* allocated, const char* path) {
+	if ( *amount == *allocated ) {
+		*allocated = *allocated == 0 ? 64 : *allocated * 2;
+		*paths = (char**) mem_realloc( *paths, sizeof(char*) * *allocated, MEM_SCRATCH );
+	}
+
+	(*paths)[*amount] = (char*) mem_malloc( strlen(path) + 1, MEM_SCRATCH );
+	strcpy((*paths)[*amount], path);
+	(*amount)++;
+}
+
+/**
+ * @brief Graph files of a batch
+ *
+ * @param input Directory whose regular files are all graphs, or manifest
+ *              listing one graph file per line ('#' starts a comment line)
+ * @param amount Receives the number of files
+ *
+ * @details Files of a directory are sorted by name, those of a manifest keep
+ *          its order.
+ *
+ * @returns List of paths, NULL on ERROR
+ */
+char** batch_list(const char* input, int* amount) {
+	char	**paths = NULL,
+		path[BATCH_PATH_SIZE];
+	int	allocated = 0;
+	struct stat	info;
+
+	*amount = 0;
+	if ( stat(input, &info) != 0 ) {
+		printf("ERROR: The batch input (%s) could not be found\n", input);
+		return NULL;
+	}
+
+	if ( S_ISDIR(info.st_mode) ) {
+		DIR	*directory = opendir(input);
+		struct dirent	*entry = NULL;
+
+		if ( directory == NULL ) {
+			printf("ERROR: The batch directory (%s) could not be opened\n", input);
+			return NULL;
+		}
+
+		while ( ( entry = readdir(directory) ) != NULL ) {
+			snprintf(path, BATCH_PATH_SIZE, "%s/%s", input, entry->d_name);
+			if ( stat(path, &info) == 0 && S_ISREG(info.st_mode) ) batch_append(&paths, amount, &allocated, path);
+		}
+		closedir(directory);
+
+		if ( *amount > 0 ) qsort(paths, *amount, sizeof(char*), batch_compare);
+	} else {
+		FILE	*manifest = fopen(input, "r");
+
+		if ( manifest == NULL ) {
+			printf("ERROR: The batch manifest (%s) could not be opened\n", input);
+			return NULL;
+		}
+
+		while ( fgets(path, BATCH_PATH_SIZE, manifest) != NULL ) {
+			char	*line = path + strspn(path, " \t");
+
+			line[strcspn(line, "\r\n")] = '\0';
+			if ( line[0] != '\0' && line[0] != '#' ) batch_append(&paths, amount, &allocated, line);
+		}
+		fclose(manifest);
+	}
+
+	if ( *amount == 0 ) {
+		printf("ERROR: The batch input (%s) has no graph files\n", input);
+		mem_free(paths);
+		return NULL;
+	}
+
+	return paths;
+}
+
+/**
+ * @brief Reads a whole file, ended by a null character
+ *
+ * @returns Contents of the file, NULL on ERROR
+ */
+char* batch_read(const char* path) {
+	FILE	*file = fopen(path, "rb");
+	char	*text = NULL;
+	long	size = 0;
+
+	if ( file == NULL ) return NULL;
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	text = (char*) mem_malloc( size + 1, MEM_SCRATCH );
+	if ( size < 0 || fread(text, 1, size, file) != (size_t) size ) {
+		mem_free(text);
+		text = NULL;
+	} else {
+		text[size] = '\0';
+	}
+
+	fclose(file);
+	return text;
+}
+
+/**
+ * @brief Builds a graph from the contents of a graph file
+ *
+ * @param text Contents of the file, changed while it is split
+ * @param path Name of the file, used in messages
+ * @param scratch Buffers of the calling worker, grown if needed
+ *
+ * @details Same format and checks as main: vertices, edges and flag, the
+ *          vertex names, then one "source-destination" per edge. Tokens are
+ *          split with strtok_r, so workers can parse at the same time.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* batch_parse(char* text, const char* path, BatchScratch* scratch) {
+	char	*save = NULL,
+		*token = NULL;
+	int	vertices = 0,
+		edges = 0,
+		flag = -1,
+		amount = 0;
+	Graph	*g = NULL;
+
+	if ( ( token = strtok_r(text, " \t\r\n", &save) ) != NULL ) vertices = atoi(token);
+	if ( ( token = strtok_r(NULL, " \t\r\n", &save) ) != NULL ) edges = atoi(token);
+	if ( ( token = strtok_r(NULL, " \t\r\n", &save) ) != NULL ) flag = atoi(token);
+
+	if ( vertices <= 0 ) {
+		printf("ERROR: (%s) Graph null\n", path);
+		return NULL;
+	} else if ( edges <= 0 ) {
+		printf("ERROR: (%s) Graph without edges\n", path);
+		return NULL;
+	} else if ( flag != NON_DIRECTED && flag != DIRECTED ) {
+		printf("ERROR: (%s) Invalid flag\n", path);
+		return NULL;
+	}
+
+	if ( ( g = graph_initializer(vertices, edges, flag) ) == NULL ) return NULL;
+
+	for ( int i = 0; i < vertices && ( token = strtok_r(NULL, " \t\r\n", &save) ) != NULL; i++ ) {
+		if ( strlen(token) >= STR_SIZE ) {
+			printf("ERROR: (%s) Vertex name (%s) longer than %d characters\n", path, token, STR_SIZE - 1);
+			graph_destroy(g);
+			return NULL;
+		}
+		graph_add_vertice(g, token);
+	}
+
+	if ( scratch->allocated < edges ) {
+		scratch->allocated = edges;
+		scratch->sources = (int*) mem_realloc( scratch->sources, sizeof(int) * edges, MEM_SCRATCH );
+		scratch->destinations = (int*) mem_realloc( scratch->destinations, sizeof(int) * edges, MEM_SCRATCH );
+	}
+
+	for ( int i = 0; i < edges && ( token = strtok_r(NULL, " \t\r\n", &save) ) != NULL; i++ ) {
+		char	*inner = NULL,
+			*source = strtok_r(token, "-", &inner),
+			*destination = strtok_r(NULL, "-", &inner);
+
+		scratch->sources[amount] = source != NULL ? graph_vertice_finder(g, source) : -1;
+		scratch->destinations[amount] = destination != NULL ? graph_vertice_finder(g, destination) : -1;
+		if ( scratch->sources[amount] == -1 || scratch->destinations[amount] == -1 ) {
+			printf("ERROR: (%s) Atleast one of your vertices (%s - %s) was not found in your graph.\n", path,
+			       source != NULL ? source : "", destination != NULL ? destination : "");
+		} else {
+			amount++;
+		}
+	}
+	graph_add_edges(g, scratch->sources, scratch->destinations, amount);
+
+	return g;
+}
+
+/**
+ * @brief Writes a graph in the format batch_parse and main read
+ *
+ * @details A non-directed edge is written once.
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int batch_write(Graph* graph, const char* path) {
+	FILE	*file = fopen(path, "w");
+	int	edges = 0;
+
+	if ( file == NULL ) {
+		printf("ERROR: The reduction file (%s) could not be opened\n", path);
+		return -1;
+	}
+
+	for ( int u = 0; u < graph->vertices_amount; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			if ( graph->flag == DIRECTED || graph->edges_index[u][k] > u ) edges++;
+		}
+	}
+
+	fprintf(file, "%d\n%d\n%d\n", graph->vertices_amount, edges, graph->flag);
+	for ( int u = 0; u < graph->vertices_amount; u++ ) fprintf(file, "%s\n", graph->vertices[u]);
+	for ( int u = 0; u < graph->vertices_amount; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			if ( graph->flag == DIRECTED || graph->edges_index[u][k] > u ) {
+				fprintf(file, "%s-%s\n", graph->vertices[u], graph->edges[u][k]);
+			}
+		}
+	}
+
+	return fclose(file) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Number of edges of a graph, a non-directed one counted once
+ */
+int batch_edges(Graph* graph) {
+	int	neighbours = 0;
+
+	for ( int u = 0; u < graph->vertices_amount; u++ ) neighbours += graph->edges_neighbours[u];
+	return graph->flag == NON_DIRECTED ? neighbours / 2 : neighbours;
+}
+
+/**
+ * @brief Parses, reduces and writes the graph of a job
+ */
+void batch_process(Batch* batch, BatchJob* job, BatchScratch* scratch) {
+	BatchResult	*result = &batch->results[job->index];
+	const char	*path = batch->paths[job->index],
+			*name = strrchr(path, '/') != NULL ? strrchr(path, '/') + 1 : path;
+	char		output[BATCH_PATH_SIZE],
+			key[CACHE_KEY_SIZE];
+	Graph		*g = NULL,
+			*original = NULL,
+			*reduced = NULL;
+	int		*order = NULL;
+	double		start = batch_clock();
+
+	result->read_seconds = job->read_seconds;
+	if ( job->text == NULL ) {
+		printf("ERROR: The graph file (%s) could not be read\n", path);
+		result->status = "unreadable";
+		return;
+	}
+
+	g = batch_parse(job->text, path, scratch);
+	mem_free(job->text);
+	result->parse_seconds = batch_clock() - start;
+	if ( g == NULL ) {
+		result->status = "invalid";
+		return;
+	}
+	result->vertices = g->vertices_amount;
+	result->edges = batch_edges(g);
+
+	start = batch_clock();
+	if ( cache_directory != NULL ) {
+		cache_key(g, key);
+		reduced = cache_load_reduction(key, "walk", g);
+	}
+	if ( reduced != NULL ) {
+		result->status = "cached";
+	} else if ( isCyclic(g) ) {
+		printf("ERROR: (%s) Your graph contains cycle! Analysis can't be done.\n", path);
+		result->status = "cyclic";
+		result->reduce_seconds = batch_clock() - start;
+		graph_destroy(g);
+		return;
+	} else {
+		if ( relabel_order != RELABEL_NONE ) {
+			order = relabel_compute(g, relabel_order);
+			original = g;
+			g = relabel_apply(original, order);
+		}
+		reduced = walk(g, NULL);
+		if ( reduced != NULL && order != NULL ) {
+			Graph	*relabelled = reduced;
+
+			reduced = relabel_restore(relabelled, original, order);
+			graph_destroy(relabelled);
+		}
+		result->status = "ok";
+		// A reduction stopped by a budget is not the reduction of the graph
+		if ( reduced != NULL && cache_directory != NULL && walk_time_budget == WALK_UNLIMITED && walk_test_budget == WALK_UNLIMITED ) {
+			cache_store_reduction(key, "walk", reduced);
+		}
+	}
+	result->reduce_seconds = batch_clock() - start;
+
+	if ( reduced == NULL ) {
+		result->status = "failed";
+	} else {
+		start = batch_clock();
+		result->reduced = batch_edges(reduced);
+		snprintf(output, BATCH_PATH_SIZE, "%s/%s", batch->output, name);
+		if ( batch_write(reduced, output) != 0 ) result->status = "unwritable";
+		result->write_seconds = batch_clock() - start;
+		graph_destroy(reduced);
+	}
+
+	if ( original != NULL ) graph_destroy(original);
+	graph_destroy(g);
+	mem_free(order);
+}
+
+/**
+ * @brief Reads the files of the batch ahead of the workers
+ *
+ * @details Waits whenever BATCH_READ_AHEAD files per worker are already
+ *          waiting, so memory stays bounded while the disk is kept busy.
+ */
+void* batch_reader(void* argument) {
+	Batch	*batch = (Batch*) argument;
+
+	for ( int i = 0; i < batch->amount; i++ ) {
+		BatchJob	job;
+		double		start = batch_clock();
+
+		job.index = i;
+		job.text = batch_read(batch->paths[i]);
+		job.read_seconds = batch_clock() - start;
+
+		pthread_mutex_lock(&batch->lock);
+		while ( batch->count == batch->capacity ) pthread_cond_wait(&batch->not_full, &batch->lock);
+		batch->queue[( batch->head + batch->count ) % batch->capacity] = job;
+		batch->count++;
+		pthread_cond_signal(&batch->not_empty);
+		pthread_mutex_unlock(&batch->lock);
+	}
+
+	pthread_mutex_lock(&batch->lock);
+	batch->done = 1;
+	pthread_cond_broadcast(&batch->not_empty);
+	pthread_mutex_unlock(&batch->lock);
+
+	return NULL;
+}
+
+/**
+ * @brief Takes jobs from the queue until the reader is done and the queue is empty
+ */
+void* batch_worker(void* argument) {
+	Batch		*batch = (Batch*) argument;
+	BatchScratch	scratch = { NULL, NULL, 0 };
+
+	for ( ;; ) {
+		BatchJob	job;
+
+		pthread_mutex_lock(&batch->lock);
+		while ( batch->count == 0 && ! batch->done ) pthread_cond_wait(&batch->not_empty, &batch->lock);
+		if ( batch->count == 0 ) {
+			pthread_mutex_unlock(&batch->lock);
+			break;
+		}
+		job = batch->queue[batch->head];
+		batch->head = ( batch->head + 1 ) % batch->capacity;
+		batch->count--;
+		pthread_cond_signal(&batch->not_full);
+		pthread_mutex_unlock(&batch->lock);
+
+		batch_process(batch, &job, &scratch);
+	}
+
+	mem_free(scratch.sources);
+	mem_free(scratch.destinations);
+	return NULL;
+}
+
+/**
+ * @brief Writes the timing summary of a batch, one line per graph
+ *
+ * @returns Number of graphs not reduced
+ */
+int batch_summary(Batch* batch, FILE* file) {
+	int	failed = 0;
+
+	fprintf(file, "%-40s %8s %8s %8s %10s %10s %10s %10s %s\n", "graph", "vertices", "edges", "reduced",
+		"read_ms", "parse_ms", "reduce_ms", "write_ms", "status");
+	for ( int i = 0; i < batch->amount; i++ ) {
+		BatchResult	*r = &batch->results[i];
+
+		fprintf(file, "%-40s %8d %8d %8d %10.3f %10.3f %10.3f %10.3f %s\n", batch->paths[i], r->vertices, r->edges, r->reduced,
+			r->read_seconds * 1e3, r->parse_seconds * 1e3, r->reduce_seconds * 1e3, r->write_seconds * 1e3, r->status);
+		if ( strcmp(r->status, "ok") != 0 && strcmp(r->status, "cached") != 0 ) failed++;
+	}
+
+	return failed;
+}
+
+/**
+ * @brief Reduces every graph of a directory or manifest on a pool of threads
+ *
+ * @param input Directory or manifest of graph files, see batch_list
+ * @param output Directory receiving one reduction per graph, under the same
+ *               file name, and the timing summary BATCH_SUMMARY
+ * @param threads Number of workers, BATCH_AUTO for one per processor
+ *
+ * @details A reader thread loads the files into a bounded queue while the
+ *          workers parse and reduce them with walk, so computation never
+ *          waits on the disk as long as reading is faster. Each worker keeps
+ *          its parsing buffers from one graph to the next. With a cache
+ *          directory, graphs reduced by an earlier run are only parsed. The graphs are
+ *          small and reduced side by side, so walk runs single threaded and
+ *          without shards, checkpoint or external closure while the batch lasts;
+ *          the workers would otherwise share the one closure file.
+ *
+ * @returns Number of graphs not reduced, -1 (ERROR) if the batch could not start
+ */
+int batch_run(const char* input, const char* output, int threads) {
+	Batch		batch;
+	pthread_t	reader,
+			handles[BATCH_MAX_THREADS];
+	int		created = 0,
+			failed = 0,
+			reading = 0,
+			saved_wavefront = wavefront_threads,
+			saved_shard = shard_workers;
+	long		saved_external = external_budget;
+	const char	*saved_checkpoint = checkpoint_path,
+			*saved_witness = witness_path;
+	char		path[BATCH_PATH_SIZE];
+	FILE		*summary = NULL;
+	double		start = batch_clock();
+
+	memset(&batch, 0, sizeof(Batch));
+	if ( ( batch.paths = batch_list(input, &batch.amount) ) == NULL ) return -1;
+
+	if ( mkdir(output, 0755) != 0 && access(output, W_OK) != 0 ) {
+		printf("ERROR: The output directory (%s) could not be created\n", output);
+		for ( int i = 0; i < batch.amount; i++ ) mem_free(batch.paths[i]);
+		mem_free(batch.paths);
+		return -1;
+	}
+
+	if ( threads == BATCH_AUTO ) threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if ( threads > BATCH_MAX_THREADS ) threads = BATCH_MAX_THREADS;
+	if ( threads < 1 ) threads = 1;
+
+	if ( checkpoint_path != NULL ) printf("WARNING: The checkpoint (%s) is not used in batch mode\n", checkpoint_path);
+	wavefront_threads = 1;
+	shard_workers = SHARD_DISABLED;
+	checkpoint_path = NULL;
+	if ( witness_path != NULL ) printf("WARNING: The witness file (%s) is not written in batch mode\n", witness_path);
+	witness_path = NULL;
+	if ( external_budget != EXTERNAL_DEFAULT_BUDGET ) printf("WARNING: The closure is not computed on disk in batch mode\n");
+	external_budget = EXTERNAL_DISABLED;
+
+	batch.output = output;
+	batch.results = (BatchResult*) mem_calloc( batch.amount, sizeof(BatchResult), MEM_SCRATCH );
+	batch.capacity = threads * BATCH_READ_AHEAD;
+	batch.queue = (BatchJob*) mem_malloc( sizeof(BatchJob) * batch.capacity, MEM_SCRATCH );
+	pthread_mutex_init(&batch.lock, NULL);
+	pthread_cond_init(&batch.not_empty, NULL);
+	pthread_cond_init(&batch.not_full, NULL);
+
+	reading = pthread_create(&reader, NULL, batch_reader, &batch) == 0;
+	if ( ! reading ) {
+		// Nobody else reads the files, the queue is filled before any work starts
+		batch.capacity = batch.amount;
+		batch.queue = (BatchJob*) mem_realloc( batch.queue, sizeof(BatchJob) * batch.capacity, MEM_SCRATCH );
+		batch_reader(&batch);
+	}
+	for ( ; created < threads; created++ ) {
+		if ( pthread_create(&handles[created], NULL, batch_worker, &batch) != 0 ) {
+			printf("WARNING: Batch running with %d workers instead of %d\n", created, threads);
+			break;
+		}
+	}
+	if ( created == 0 ) batch_worker(&batch);
+
+	for ( int t = 0; t < created; t++ ) pthread_join(handles[t], NULL);
+	if ( reading ) pthread_join(reader, NULL);
+
+	snprintf(path, BATCH_PATH_SIZE, "%s/%s", output, BATCH_SUMMARY);
+	if ( ( summary = fopen(path, "w") ) != NULL ) {
+		failed = batch_summary(&batch, summary);
+		fclose(summary);
+	} else {
+		printf("ERROR: The batch summary (%s) could not be written\n", path);
+		failed = batch_summary(&batch, stdout);
+	}
+
+	printf("Batch of %d graphs on %d workers: %d reduced, %d failed, %g seconds (summary in %s)\n",
+	       batch.amount, created > 0 ? created : 1, batch.amount - failed, failed, batch_clock() - start, path);
+
+	wavefront_threads = saved_wavefront;
+	shard_workers = saved_shard;
+	checkpoint_path = saved_checkpoint;
+	witness_path = saved_witness;
+	external_budget = saved_external;
+
+	pthread_cond_destroy(&batch.not_full);
+	pthread_cond_destroy(&batch.not_empty);
+	pthread_mutex_destroy(&batch.lock);
+	for ( int i = 0; i < batch.amount; i++ ) mem_free(batch.paths[i]);
+	mem_free(batch.paths);
+	mem_free(batch.results);
+	mem_free(batch.queue);
+	return failed;
+}
@@ -0,0 +1,114 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/batch.h
+ *
+ * @brief Struct of a batch of graph files reduced by a pool of threads
+ *
+ */
+#ifndef BATCH_H_
+#define BATCH_H_
+
+	#include <pthread.h>
+
+	/**
+	 * @name Batch definitions
+	 */
+	/**@{*/
+	#define BATCH_AUTO		0		/* One worker per online processor */
+	#define BATCH_MAX_THREADS	64		/* Upper bound on the number of workers */
+	#define BATCH_READ_AHEAD	2		/* Files read and waiting per worker */
+	#define BATCH_PATH_SIZE		4096		/* Max size of a path */
+	#define BATCH_SUMMARY		"summary.txt"	/* Timing summary written in the output directory */
+	#define BATCH_DEFAULT_OUTPUT	"reduced"	/* Output directory when none is given */
+	/**@}*/
+
+	typedef struct BatchJob {
+
+		/**
+		 * @name File read by the reader thread
+		 */
+		/**@{*/
+		int	index;			/* Position of the file in the batch */
+		char*	text;			/* Contents of the file, NULL if it could not be read */
+		double	read_seconds;		/* Time spent reading it */
+		/**@}*/
+
+	} BatchJob;
+
+	typedef struct BatchResult {
+
+		/**
+		 * @name Outcome of one graph
+		 */
+		/**@{*/
+		const char*	status;			/* "ok" or why the graph was not reduced */
+		int		vertices;		/* Vertices of the graph */
+		int		edges;			/* Edges of the graph */
+		int		reduced;		/* Edges of its transitive reduction */
+		double		read_seconds;		/* Reading the file */
+		double		parse_seconds;		/* Building the graph */
+		double		reduce_seconds;		/* Cycle check and reduction */
+		double		write_seconds;		/* Writing the reduction */
+		/**@}*/
+
+	} BatchResult;
+
+	typedef struct BatchScratch {
+
+		/**
+		 * @name Buffers reused by a worker from one graph to the next
+		 */
+		/**@{*/
+		int*	sources;		/* Sources of the edges read, see graph_add_edges */
+		int*	destinations;		/* Destinations of the edges read */
+		int	allocated;		/* Edges both arrays can hold */
+		/**@}*/
+
+	} BatchScratch;
+
+	typedef struct Batch {
+
+		/**
+		 * @name Graphs of the batch
+		 */
+		/**@{*/
+		char**		paths;			/* Graph files */
+		int		amount;			/* Number of files */
+		const char*	output;			/* Directory receiving the reductions */
+		BatchResult*	results;		/* Outcome of each file */
+		/**@}*/
+
+		/**
+		 * @name Queue between the reader thread and the workers
+		 */
+		/**@{*/
+		BatchJob*	queue;			/* Ring of files read and not taken yet */
+		int		capacity;		/* Slots of the ring */
+		int		head;			/* Next job to be taken */
+		int		count;			/* Jobs in the ring */
+		int		done;			/* 1 once every file was read */
+		pthread_mutex_t	lock;
+		pthread_cond_t	not_empty;
+		pthread_cond_t	not_full;
+		/**@}*/
+
+	} Batch;
+
+	extern int batch_threads;	/* Number of workers, BATCH_AUTO for one per processor */
+
+#endif /* BATCH_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Batch operations
+ */
+/**@{*/
+extern Graph* batch_parse(char* text, const char* path, BatchScratch* scratch);
+extern int    batch_write(Graph* graph, const char* path);
+extern int    batch_run(const char* input, const char* output, int threads);
+/**@}*/
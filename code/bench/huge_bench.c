@@ -0,0 +1,127 @@
+#include "../graph.h"
+#include "../bitset.h"
+#include "../kernels.h"
+#include "../hugealloc.h"
+#include "../memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_MEGABYTES	512		/* Size of the closure */
+#define BENCH_DEFAULT_READS	( 1L << 24 )	/* Random words read */
+#define BENCH_UNIONS		( 1L << 16 )	/* Random rows merged into one */
+
+/**
+ * @brief Monotonic time in seconds
+ */
+double bench_clock(void) {
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Kilobytes of anonymous memory of the process backed by huge pages, -1 if unknown
+ */
+long bench_huge_kilobytes(void) {
+	FILE	*file = fopen("/proc/self/smaps_rollup", "r");
+	char	line[256];
+	long	kilobytes = -1;
+
+	if ( file == NULL ) return -1;
+
+	while ( fgets(line, sizeof(line), file) != NULL ) {
+		if ( sscanf(line, "AnonHugePages: %ld kB", &kilobytes) == 1 ) break;
+	}
+
+	fclose(file);
+	return kilobytes;
+}
+
+/**
+ * @brief Next number of a xorshift generator
+ */
+unsigned long bench_random(unsigned long* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/**
+ * @brief Times random accesses to a closure, with or without huge pages
+ *
+ * @details Random words are read all over the closure, which misses the TLB
+ *          on almost every read with 4 KB pages, then random rows are merged
+ *          into one as walk_reduce does. Both runs use the same sequence.
+ */
+void bench_run(int rows, long reads, int pages) {
+	BitMatrix	*closure = NULL;
+	WORD		*merged = NULL,
+			sum = 0;
+	unsigned long	state = 88172645463325252UL;
+	long		before = bench_huge_kilobytes();
+	double		start = 0,
+			read_seconds = 0,
+			union_seconds = 0;
+
+	huge_pages = pages;
+	closure = bitmatrix_initializer(rows);
+	merged = (WORD*) mem_calloc( closure->words_per_row + 1, sizeof(WORD), MEM_SCRATCH );
+
+	// Every page is touched before timing, so faults are not measured
+	memset(closure->data, 0x5A, sizeof(WORD) * (size_t) rows * closure->words_per_row);
+
+	start = bench_clock();
+	for ( long r = 0; r < reads; r++ ) {
+		unsigned long	random = bench_random(&state);
+
+		sum += bitmatrix_row(closure, (int) ( random % rows ))[( random >> 32 ) % closure->words_per_row];
+	}
+	read_seconds = bench_clock() - start;
+
+	start = bench_clock();
+	for ( long u = 0; u < BENCH_UNIONS; u++ ) {
+		kernels.row_union(merged, bitmatrix_row(closure, (int) ( bench_random(&state) % rows )), closure->words_per_row);
+	}
+	union_seconds = bench_clock() - start;
+
+	printf("huge pages %-3s: %ld random reads %.2f ns each, %ld row unions %.2f us each, %ld kB on huge pages (checksum %lx)\n",
+	       pages ? "on" : "off", reads, read_seconds * 1e9 / reads, BENCH_UNIONS, union_seconds * 1e6 / BENCH_UNIONS,
+	       bench_huge_kilobytes() - before, (unsigned long) ( sum ^ merged[0] ));
+
+	mem_free(merged);
+	bitmatrix_destroy(closure);
+}
+
+/**
+ * @brief Compares closures on regular and huge pages
+ *
+ * @details Usage: bench_huge [megabytes] [reads] [-N]
+ */
+int main(int argc, char** argv) {
+	long	megabytes = BENCH_DEFAULT_MEGABYTES,
+		reads = BENCH_DEFAULT_READS;
+	int	rows = 0;
+
+	for ( int i = 1, position = 0; i < argc; i++ ) {
+		if ( strcmp(argv[i], "-N") == 0 ) {
+			huge_interleave = 1;
+		} else if ( position++ == 0 ) {
+			megabytes = atol(argv[i]);
+		} else {
+			reads = atol(argv[i]);
+		}
+	}
+
+	kernels_initializer();
+	rows = (int) sqrt((double) megabytes * 1024 * 1024 * 8);
+	printf("Closure of %d rows (%ld MB)%s\n", rows, megabytes, huge_interleave ? ", interleaved over the NUMA nodes" : "");
+
+	bench_run(rows, reads, 0);
+	bench_run(rows, reads, 1);
+	return 0;
+}
@@ -0,0 +1,149 @@
+#include "../graph.h"
+#include "../loader.h"
+#include "../memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define CHECK_THREADS		8		/* Threads of the parallel load */
+#define CHECK_CASES		40		/* Random graph files checked */
+#define CHECK_TEXT_SIZE		( 1 << 16 )	/* Bytes of messages kept per load */
+
+/**
+ * @brief Next number of a xorshift generator
+ */
+unsigned long check_random(unsigned long* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/**
+ * @brief Writes a random graph file, with some edges loader_load must reject
+ *
+ * @details Edges are written one per line, with spaces, tabs and CRLF ends
+ *          mixed in, unknown vertices, missing names and extra separators.
+ *          The edge count of the header is sometimes lower than the lines,
+ *          so the edges of the last chunks are dropped.
+ *
+ * @returns Bytes of the edge list
+ */
+long check_write(const char* path, unsigned long* state) {
+	FILE	*file = fopen(path, "w");
+	int	vertices = 50 + (int) ( check_random(state) % 900 ),
+		lines = 700 + (int) ( check_random(state) % 290 ),
+		edges = check_random(state) % 3 == 0 ? lines / 2 : lines;
+	long	start = 0;
+
+	fprintf(file, "%d\n%d\n%d\n", vertices, edges, DIRECTED);
+	for ( int v = 0; v < vertices; v++ ) fprintf(file, "vertex%d\n", v);
+	start = ftell(file);
+
+	for ( int e = 0; e < lines; e++ ) {
+		int		u = (int) ( check_random(state) % vertices ),
+				w = (int) ( check_random(state) % vertices );
+		const char	*end = check_random(state) % 5 == 0 ? "\r\n" : "\n";
+
+		switch ( check_random(state) % 16 ) {
+			case 0:  fprintf(file, "vertex%d-missing%d%s", u, e, end); break;
+			case 1:  fprintf(file, "vertex%d-%s", u, end); break;
+			case 2:  fprintf(file, "--vertex%d--vertex%d%s", u, w, end); break;
+			case 3:  fprintf(file, "vertex%d-vertex%d-vertex%d%s", u, w, u, end); break;
+			case 4:  fprintf(file, "\tvertex%d-vertex%d %s", u, w, end); break;
+			default: fprintf(file, "vertex%d-vertex%d%s", u, w, end); break;
+		}
+	}
+
+	start = ftell(file) - start;
+	fclose(file);
+	return start;
+}
+
+/**
+ * @brief Loads a graph file, keeping what loader_load prints
+ *
+ * @param text Receives the messages, CHECK_TEXT_SIZE bytes at most
+ */
+Graph* check_load(const char* path, int threads, char* text) {
+	char	name[] = "/tmp/loader_check_outXXXXXX";
+	int	fd = mkstemp(name),
+		saved = dup(STDOUT_FILENO);
+	long	size = 0;
+	Graph	*g = NULL;
+
+	fflush(stdout);
+	dup2(fd, STDOUT_FILENO);
+	g = loader_load(path, threads);
+	fflush(stdout);
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+
+	size = (long) lseek(fd, 0, SEEK_CUR);
+	lseek(fd, 0, SEEK_SET);
+	size = read(fd, text, size < CHECK_TEXT_SIZE - 1 ? size : CHECK_TEXT_SIZE - 1);
+	text[size > 0 ? size : 0] = '\0';
+	close(fd);
+	unlink(name);
+	return g;
+}
+
+/**
+ * @brief Checks if two graphs have the same vertices and the same lists of neighbours
+ *
+ * @returns 1 if equal, otherwise 0
+ */
+int check_same(Graph* first, Graph* second) {
+	if ( first == NULL || second == NULL ) return first == second;
+	if ( first->vertices_amount != second->vertices_amount || first->edges_amount != second->edges_amount ) return 0;
+
+	for ( int u = 0; u < first->vertices_amount; u++ ) {
+		if ( strcmp(first->vertices[u], second->vertices[u]) != 0 ) return 0;
+		if ( first->edges_neighbours[u] != second->edges_neighbours[u] ) return 0;
+		if ( memcmp(first->edges_index[u], second->edges_index[u], sizeof(int) * first->edges_neighbours[u]) != 0 ) return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Checks that loading a graph in several chunks gives what loading it serially does
+ *
+ * @details Usage: loader_check [cases]. Every file is loaded by one thread and
+ *          by CHECK_THREADS; the graphs must be equal and the messages printed,
+ *          the rejected edges among them, the same and in the same order.
+ */
+int main(int argc, char** argv) {
+	char		path[] = "/tmp/loader_check_graphXXXXXX",
+			*serial_text = (char*) malloc( CHECK_TEXT_SIZE ),
+			*parallel_text = (char*) malloc( CHECK_TEXT_SIZE );
+	int		cases = argc > 1 ? atoi(argv[1]) : CHECK_CASES,
+			failed = 0,
+			fd = mkstemp(path);
+	unsigned long	state = 88172645463325252UL;
+
+	close(fd);
+	for ( int c = 0; c < cases; c++ ) {
+		long	bytes = check_write(path, &state);
+		int	chunks = bytes / LOADER_MIN_CHUNK < CHECK_THREADS ? (int) ( bytes / LOADER_MIN_CHUNK ) : CHECK_THREADS;
+		Graph	*serial = check_load(path, 1, serial_text),
+			*parallel = check_load(path, CHECK_THREADS, parallel_text);
+
+		if ( chunks < 2 || ! check_same(serial, parallel) || strcmp(serial_text, parallel_text) != 0 ) {
+			printf("FAILED case %d: %ld bytes of edges in %d chunks, graphs %s, messages %s\n", c, bytes, chunks,
+			       check_same(serial, parallel) ? "equal" : "different", strcmp(serial_text, parallel_text) == 0 ? "equal" : "different");
+			failed++;
+		}
+
+		if ( serial != NULL ) graph_destroy(serial);
+		if ( parallel != NULL ) graph_destroy(parallel);
+	}
+
+	unlink(path);
+	free(serial_text);
+	free(parallel_text);
+	printf("Loader check: %d of %d files loaded the same by 1 and %d threads\n", cases - failed, cases, CHECK_THREADS);
+	return failed == 0 ? 0 : 1;
+}
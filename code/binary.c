@@ -0,0 +1,199 @@
+#include "graph.h"
+#include "binary.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/**
+ * @brief Rounds a byte offset up to the next section boundary
+ */
+long binary_align(long offset) {
+	return ( offset + BINARY_ALIGN - 1 ) / BINARY_ALIGN * BINARY_ALIGN;
+}
+
+/**
+ * @brief Number of neighbours listed by a graph
+ */
+int binary_entries(Graph* graph) {
+	int	entries = 0;
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) entries += graph->edges_neighbours[i];
+	return entries;
+}
+
+/**
+ * @brief Bytes needed by the binary form of a graph
+ */
+long binary_graph_size(Graph* graph) {
+	long	size = binary_align(sizeof(BinaryGraph));
+
+	size = binary_align(size + (long) ( STR_SIZE + 1 ) * graph->vertices_amount);
+	size = binary_align(size + (long) sizeof(int) * ( graph->vertices_amount + 1 ));
+	return binary_align(size + (long) sizeof(int) * binary_entries(graph));
+}
+
+/**
+ * @brief Writes the binary form of a graph
+ *
+ * @param graph Graph to be written
+ * @param memory Receives the block, binary_graph_size(graph) bytes
+ *
+ * @details The block holds no pointers, so it can be copied, saved to a file
+ *          or shared between processes as it is.
+ *
+ * @returns The block, as a BinaryGraph
+ */
+BinaryGraph* binary_graph_write(Graph* graph, void* memory) {
+	BinaryGraph	*image = (BinaryGraph*) memory;
+	int	*offsets = NULL,
+		*targets = NULL;
+
+	memset(image, 0, sizeof(BinaryGraph));
+	memcpy(image->magic, BINARY_MAGIC, 8);
+	image->flag = graph->flag;
+	image->vertices_amount = graph->vertices_amount;
+	image->edges_amount = graph->edges_amount;
+	image->entries = binary_entries(graph);
+	image->names = binary_align(sizeof(BinaryGraph));
+	image->offsets = binary_align(image->names + (long) ( STR_SIZE + 1 ) * image->vertices_amount);
+	image->targets = binary_align(image->offsets + (long) sizeof(int) * ( image->vertices_amount + 1 ));
+	image->size = binary_graph_size(graph);
+
+	offsets = binary_graph_offsets(image);
+	targets = binary_graph_targets(image);
+	offsets[0] = 0;
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		strncpy(binary_graph_name(image, i), graph->vertices[i], STR_SIZE + 1);
+		memcpy(targets + offsets[i], graph->edges_index[i], sizeof(int) * graph->edges_neighbours[i]);
+		offsets[i + 1] = offsets[i] + graph->edges_neighbours[i];
+	}
+
+	return image;
+}
+
+/**
+ * @brief Name of a vertex of a binary graph
+ */
+char* binary_graph_name(BinaryGraph* image, int vertice) {
+	return (char*) image + image->names + (long) ( STR_SIZE + 1 ) * vertice;
+}
+
+/**
+ * @brief First neighbour of each vertex of a binary graph, plus one past the last
+ */
+int* binary_graph_offsets(BinaryGraph* image) {
+	return (int*) ( (char*) image + image->offsets );
+}
+
+/**
+ * @brief Neighbours of every vertex of a binary graph, one after the other
+ */
+int* binary_graph_targets(BinaryGraph* image) {
+	return (int*) ( (char*) image + image->targets );
+}
+
+/**
+ * @brief Builds a graph from its binary form
+ *
+ * @param image Block written by binary_graph_write
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* binary_graph_read(BinaryGraph* image) {
+	Graph	*g = graph_initializer(image->vertices_amount, image->edges_amount, image->flag);
+	int	*offsets = binary_graph_offsets(image),
+		*targets = binary_graph_targets(image),
+		*sources = NULL,
+		*destinations = NULL,
+		amount = 0;
+
+	if ( g == NULL ) return NULL;
+
+	sources = (int*) mem_malloc( sizeof(int) * image->entries + 1, MEM_SCRATCH );
+	destinations = (int*) mem_malloc( sizeof(int) * image->entries + 1, MEM_SCRATCH );
+
+	for ( int i = 0; i < image->vertices_amount; i++ ) {
+		graph_add_vertice(g, binary_graph_name(image, i));
+	}
+
+	// A non-directed edge is stored on both vertices but inserted once
+	for ( int i = 0; i < image->vertices_amount; i++ ) {
+		for ( int k = offsets[i]; k < offsets[i + 1]; k++ ) {
+			if ( image->flag == NON_DIRECTED && targets[k] < i ) continue;
+			sources[amount] = i;
+			destinations[amount] = targets[k];
+			amount++;
+		}
+	}
+	graph_add_edges(g, sources, destinations, amount);
+
+	mem_free(sources);
+	mem_free(destinations);
+	return g;
+}
+
+/**
+ * @brief Saves the binary form of a graph to a file
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int binary_graph_save(Graph* graph, const char* path) {
+	long	size = binary_graph_size(graph);
+	void	*memory = mem_calloc( 1, size, MEM_SCRATCH );
+	FILE	*file = fopen(path, "wb");
+	int	controller = 0;
+
+	if ( file == NULL ) {
+		printf("ERROR: The binary graph file (%s) could not be opened\n", path);
+		mem_free(memory);
+		return -1;
+	}
+
+	binary_graph_write(graph, memory);
+	if ( fwrite(memory, 1, size, file) != (size_t) size ) {
+		printf("ERROR: The binary graph file (%s) could not be written\n", path);
+		controller = -1;
+	}
+
+	fclose(file);
+	mem_free(memory);
+	return controller;
+}
+
+/**
+ * @brief Loads a graph saved by binary_graph_save
+ *
+ * @details The file is mapped and checked before any vertex is read.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* binary_graph_load(const char* path) {
+	int	fd = open(path, O_RDONLY);
+	long	size = 0;
+	BinaryGraph	*image = NULL;
+	Graph	*g = NULL;
+
+	if ( fd < 0 ) {
+		printf("ERROR: The binary graph file (%s) could not be opened\n", path);
+		return NULL;
+	}
+
+	size = (long) lseek(fd, 0, SEEK_END);
+	image = size >= (long) sizeof(BinaryGraph) ? (BinaryGraph*) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	close(fd);
+
+	if ( image == MAP_FAILED || memcmp(image->magic, BINARY_MAGIC, 8) != 0 || image->size > size ||
+	     image->vertices_amount < 0 || image->targets + (long) sizeof(int) * image->entries > size ) {
+		printf("ERROR: The file (%s) is not a binary graph\n", path);
+		if ( image != MAP_FAILED ) munmap(image, size);
+		return NULL;
+	}
+
+	g = binary_graph_read(image);
+	munmap(image, size);
+	return g;
+}
@@ -0,0 +1,64 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/binary.h
+ *
+ * @brief Struct of a graph stored in one flat block (compressed sparse rows)
+ *
+ */
+#ifndef BINARY_H_
+#define BINARY_H_
+
+	/**
+	 * @name Binary graph definitions
+	 */
+	/**@{*/
+	#define BINARY_MAGIC		"TRGRAPH1"	/* First bytes of a binary graph */
+	#define BINARY_ALIGN		64		/* Every section starts at a multiple of this offset */
+	/**@}*/
+
+	typedef struct BinaryGraph {
+
+		/**
+		 * @name Graph information
+		 */
+		/**@{*/
+		char	magic[8];		/* BINARY_MAGIC */
+		int	flag;			/* As Graph::flag */
+		int	vertices_amount;	/* Number of vertices */
+		int	edges_amount;		/* As Graph::edges_amount, undirected edges counted once */
+		int	entries;		/* Number of neighbours listed, both directions of undirected edges */
+		/**@}*/
+
+		/**
+		 * @name Sections, as byte offsets from the start of the block
+		 */
+		/**@{*/
+		long	names;			/* STR_SIZE + 1 bytes per vertex name */
+		long	offsets;		/* First neighbour of each vertex in targets, plus one past the last */
+		long	targets;		/* Positions of the neighbours, in Graph::edges_index order */
+		long	size;			/* Bytes of the whole block */
+		/**@}*/
+
+	} BinaryGraph;
+
+#endif /* BINARY_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Binary graph operations
+ */
+/**@{*/
+extern long binary_graph_size(Graph* graph);
+extern BinaryGraph* binary_graph_write(Graph* graph, void* memory);
+extern char* binary_graph_name(BinaryGraph* image, int vertice);
+extern int*  binary_graph_offsets(BinaryGraph* image);
+extern int*  binary_graph_targets(BinaryGraph* image);
+extern Graph* binary_graph_read(BinaryGraph* image);
+extern int  binary_graph_save(Graph* graph, const char* path);
+extern Graph* binary_graph_load(const char* path);
+/**@}*/
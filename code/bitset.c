@@ -0,0 +1,278 @@
+#include "graph.h"
+#include "bitset.h"
+#include "kernels.h"
+#include "memtrack.h"
+#include "hugealloc.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Initializes an empty square Boolean matrix
+ *
+ * @param rows Number of rows (and columns) of the matrix
+ *
+ * @details Allocates all rows in one contiguous zeroed block, each row
+ *          padded to a whole number of WORDs. Large blocks are put on huge
+ *          pages, see huge_calloc
+ *
+ * @returns Reference to newly create BitMatrix
+ */
+BitMatrix* bitmatrix_initializer(int rows) {
+	BitMatrix	*m = (BitMatrix*) mem_malloc( sizeof(BitMatrix), MEM_CLOSURE );
+
+	m->rows = rows;
+	m->words_per_row = ( rows + WORD_BITS - 1 ) / WORD_BITS;
+	m->data = (WORD*) huge_calloc( (size_t) rows * m->words_per_row + 1, sizeof(WORD), MEM_CLOSURE );
+
+	return m;
+}
+
+/**
+ * @brief Frees a Boolean matrix
+ *
+ * @param m Matrix to be freed
+ */
+void bitmatrix_destroy(BitMatrix* m) {
+	if ( m == NULL ) return;
+
+	huge_free(m->data);
+	mem_free(m);
+}
+
+/**
+ * @brief Returns the first WORD of a row
+ *
+ * @param m Matrix to be iterated
+ * @param row Position of the row
+ */
+WORD* bitmatrix_row(BitMatrix* m, int row) {
+	return m->data + (size_t) row * m->words_per_row;
+}
+
+/**
+ * @brief Sets the bit of given row and column
+ */
+void bitmatrix_set(BitMatrix* m, int row, int column) {
+	bitmatrix_row(m, row)[column / WORD_BITS] |= (WORD) 1 << ( column % WORD_BITS );
+}
+
+/**
+ * @brief Reads the bit of given row and column
+ *
+ * @returns 1 if the bit is set, otherwise 0
+ */
+int bitmatrix_test(BitMatrix* m, int row, int column) {
+	return ( bitmatrix_row(m, row)[column / WORD_BITS] >> ( column % WORD_BITS ) ) & 1;
+}
+
+/**
+ * @brief Compares two matrices of the same size row by row
+ *
+ * @returns 1 if every row is equal, otherwise 0
+ */
+int bitmatrix_equal(BitMatrix* first, BitMatrix* second) {
+	if ( first->rows != second->rows ) return 0;
+
+	for ( int i = 0; i < first->rows; i++ ) {
+		if ( ! kernels.row_equal(bitmatrix_row(first, i), bitmatrix_row(second, i), first->words_per_row) ) return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Builds the adjacency matrix of a graph
+ *
+ * @param graph Graph to be iterated
+ *
+ * @details Row i has bit j set when vertex j is a neighbour of vertex i
+ *
+ * @returns Reference to newly create BitMatrix
+ */
+BitMatrix* bitmatrix_from_graph(Graph* graph) {
+	BitMatrix	*m = bitmatrix_initializer(graph->vertices_amount);
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[i]; k++ ) {
+			bitmatrix_set(m, i, graph->edges_index[i][k]);
+		}
+	}
+
+	return m;
+}
+
+/**
+ * @brief Boolean product of two matrices with the Method of Four Russians
+ *
+ * @param a Left matrix
+ * @param b Right matrix
+ * @param result Matrix that receives a * b, must not alias a or b
+ *
+ * @details Columns are processed in tiles of TILE_WORDS words. Inside a tile,
+ *          the rows of b are taken RUSSIANS_BITS at a time and every OR
+ *          combination of them is stored in a lookup table, so each row of a
+ *          consumes RUSSIANS_BITS of its bits with one table lookup and one
+ *          word-parallel OR over the tile instead of RUSSIANS_BITS of them.
+ */
+void bitmatrix_multiply(BitMatrix* a, BitMatrix* b, BitMatrix* result) {
+	int	n = a->rows,
+		words = a->words_per_row;
+	WORD	*table = (WORD*) mem_malloc( sizeof(WORD) * RUSSIANS_TABLE * TILE_WORDS, MEM_CLOSURE );
+
+	memset(result->data, 0, sizeof(WORD) * (size_t) n * words);
+
+	for ( int tile = 0; tile < words; tile += TILE_WORDS ) {
+		int	tile_size = ( words - tile < TILE_WORDS ) ? words - tile : TILE_WORDS;
+
+		for ( int k = 0; k < n; k += RUSSIANS_BITS ) {
+			int	group = ( n - k < RUSSIANS_BITS ) ? n - k : RUSSIANS_BITS;
+			int	entries = 1 << group;
+
+			// Every entry extends a smaller one with its lowest row
+			memset(table, 0, sizeof(WORD) * tile_size);
+			for ( int mask = 1; mask < entries; mask++ ) {
+				int	lowest = __builtin_ctz(mask);
+				WORD	*entry = table + (size_t) mask * tile_size,
+					*previous = table + (size_t) ( mask & ( mask - 1 ) ) * tile_size,
+					*b_row = bitmatrix_row(b, k + lowest) + tile;
+
+				memcpy(entry, previous, sizeof(WORD) * tile_size);
+				kernels.row_union(entry, b_row, tile_size);
+			}
+
+			// k is a multiple of RUSSIANS_BITS, so the group never crosses a WORD
+			for ( int i = 0; i < n; i++ ) {
+				int	index = (int) ( ( bitmatrix_row(a, i)[k / WORD_BITS] >> ( k % WORD_BITS ) ) & (WORD) ( entries - 1 ) );
+
+				if ( index != 0 ) {
+					kernels.row_union(bitmatrix_row(result, i) + tile, table + (size_t) index * tile_size, tile_size);
+				}
+			}
+		}
+	}
+
+	mem_free(table);
+}
+
+/**
+ * @brief Transitive closure of a Boolean matrix by repeated squaring
+ *
+ * @param m Adjacency matrix, replaced by its transitive closure
+ *
+ * @details After t squarings m holds every path of length up to 2^t, so
+ *          the loop stops after at most log2(rows) + 1 products, as soon as
+ *          a product adds no new bit.
+ */
+void bitmatrix_closure(BitMatrix* m) {
+	BitMatrix	*product = bitmatrix_initializer(m->rows);
+	int	changed = 1;
+
+	while ( changed ) {
+		changed = 0;
+		bitmatrix_multiply(m, m, product);
+
+		// The product holds the new bits of a row unless it is already covered by it
+		for ( int i = 0; i < m->rows; i++ ) {
+			WORD	*row = bitmatrix_row(m, i),
+				*new_row = bitmatrix_row(product, i);
+
+			kernels.row_difference(new_row, row, m->words_per_row);
+			if ( kernels.row_popcount(new_row, m->words_per_row) != 0 ) {
+				kernels.row_union(row, new_row, m->words_per_row);
+				changed = 1;
+			}
+		}
+	}
+
+	bitmatrix_destroy(product);
+}
+
+/**
+ * @brief Constructs direct transitive closure of all graph vertices with the Boolean matrix engine
+ *
+ * @param graph Graph to be iterated
+ *
+ * @details Used by direct_transitive_closure for dense graphs, where the
+ *          per-source depth-first search touches every edge once per source.
+ *          The closure matrix is kept as Graph::closure_rows and converted
+ *          back to the vertex names of Graph::transitive_closure.
+ */
+void bitmatrix_transitive_closure(Graph* graph) {
+	BitMatrix	*m = bitmatrix_from_graph(graph);
+	int	pos = 0;
+
+	bitmatrix_closure(m);
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		// A vertex is not part of its own direct transitive closure, even on an undirected graph
+		bitmatrix_row(m, i)[i / WORD_BITS] &= ~( (WORD) 1 << ( i % WORD_BITS ) );
+
+		pos = 0;
+		for ( int j = 0; j < graph->vertices_amount; j++ ) {
+			if ( bitmatrix_test(m, i, j) ) {
+				graph->transitive_closure[i][pos] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_CLOSURE );
+				strcpy( graph->transitive_closure[i][pos], graph->vertices[j] );
+				pos++;
+			}
+		}
+		graph->num_transitive_closure[i] = pos;
+	}
+
+	bitmatrix_destroy(graph->closure_rows);
+	graph->closure_rows = m;
+}
+
+/**
+ * @brief Descendant and ancestor rows of a directed acyclic graph, from one topological sweep
+ *
+ * @param graph Graph to be iterated
+ * @param descendants Receives row i column j set if j is reachable from i
+ * @param ancestors Receives row i column j set if i is reachable from j
+ *
+ * @details graph_descendants_first puts every vertex after its neighbours.
+ *          Going forward through that order, the descendants of a vertex are
+ *          its neighbours and their rows, which are already done; going
+ *          backward through it in the same loop, a vertex comes after all its
+ *          predecessors, so its ancestors are complete and passed on to each
+ *          of its neighbours. A vertex is not part of its own rows, as in
+ *          direct_transitive_closure.
+ *
+ * @returns 0 if OK, -1 if graph is not a directed acyclic graph, the rows are then not computed
+ */
+int bitmatrix_reachability(Graph* graph, BitMatrix** descendants, BitMatrix** ancestors) {
+	int	n = graph->vertices_amount,
+		words = 0;
+	int	*order = NULL;
+
+	if ( graph->flag != DIRECTED || isCyclic(graph) ) return -1;
+
+	order = graph_descendants_first(graph);
+	*descendants = bitmatrix_initializer(n);
+	*ancestors = bitmatrix_initializer(n);
+	words = ( *descendants )->words_per_row;
+
+	for ( int p = 0; p < n; p++ ) {
+		int	u = order[p],
+			w = order[n - 1 - p];
+		WORD	*down = bitmatrix_row(*descendants, u),
+			*up = bitmatrix_row(*ancestors, w);
+
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			int	v = graph->edges_index[u][k];
+
+			kernels.row_union(down, bitmatrix_row(*descendants, v), words);
+			down[v / WORD_BITS] |= (WORD) 1 << ( v % WORD_BITS );
+		}
+
+		for ( int k = 0; k < graph->edges_neighbours[w]; k++ ) {
+			WORD	*below = bitmatrix_row(*ancestors, graph->edges_index[w][k]);
+
+			kernels.row_union(below, up, words);
+			below[w / WORD_BITS] |= (WORD) 1 << ( w % WORD_BITS );
+		}
+	}
+
+	mem_free(order);
+	return 0;
+}
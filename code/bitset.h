@@ -0,0 +1,61 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/bitset.h
+ *
+ * @brief Struct of a Boolean matrix stored as rows of machine words
+ *
+ */
+#ifndef BITSET_H_
+#define BITSET_H_
+
+	#include <stdint.h>
+
+	/**
+	 * @name Bitset definitions
+	 */
+	/**@{*/
+	#define WORD				uint64_t	/* Machine word holding 64 columns of a row */
+	#define WORD_BITS			64		/* Number of columns in a WORD */
+	#define RUSSIANS_BITS			8		/* Rows combined by each Four Russians lookup table */
+	#define RUSSIANS_TABLE			256		/* Entries of a lookup table (2 ^ RUSSIANS_BITS) */
+	#define TILE_WORDS			32		/* Words of a column tile, keeps a lookup table (64KB) in cache */
+	#define CLOSURE_DENSE_THRESHOLD		0.25		/* Density from which the closure uses the Boolean matrix engine */
+	/**@}*/
+
+	typedef struct BitMatrix {
+
+		/**
+		 * @name Boolean matrix information
+		 */
+		/**@{*/
+		int	rows;			/* Number of rows, equal to the number of columns */
+		int	words_per_row;		/* Number of WORDs of each row */
+		WORD*	data;			/* Rows stored one after the other */
+		/**@}*/
+
+	} BitMatrix;
+
+#endif /* BITSET_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Bitset operations
+ */
+/**@{*/
+extern BitMatrix* bitmatrix_initializer(int rows);
+extern void  bitmatrix_destroy(BitMatrix* m);
+extern WORD* bitmatrix_row(BitMatrix* m, int row);
+extern void  bitmatrix_set(BitMatrix* m, int row, int column);
+extern int   bitmatrix_test(BitMatrix* m, int row, int column);
+extern int   bitmatrix_equal(BitMatrix* first, BitMatrix* second);
+extern BitMatrix* bitmatrix_from_graph(Graph* graph);
+extern void  bitmatrix_multiply(BitMatrix* a, BitMatrix* b, BitMatrix* result);
+extern void  bitmatrix_closure(BitMatrix* m);
+extern void  bitmatrix_transitive_closure(Graph* graph);
+extern int   bitmatrix_reachability(Graph* graph, BitMatrix** descendants, BitMatrix** ancestors);
+/**@}*/
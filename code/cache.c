@@ -0,0 +1,466 @@
+#include "graph.h"
+#include "bitset.h"
+#include "roaring.h"
+#include "cache.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+const char* cache_directory = NULL;
+long	    cache_budget = CACHE_DEFAULT_BUDGET;
+
+#define CACHE_PATH_SIZE		4096
+#define CACHE_SEED_HIGH		0x9E3779B97F4A7C15UL
+#define CACHE_SEED_LOW		0xC2B2AE3D27D4EB4FUL
+
+static long		cache_estimate = -1;	/* Bytes of entries in the directory since its last scan, -1 before it */
+static pthread_mutex_t	cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Final mix of splitmix64, spreads every input bit over the result
+ */
+uint64_t cache_mix(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xBF58476D1CE4E5B9UL;
+	x ^= x >> 27;
+	x *= 0x94D049BB133111EBUL;
+	return x ^ ( x >> 31 );
+}
+
+/**
+ * @brief FNV-1a hash of a vertex name, started from a seed
+ */
+uint64_t cache_name_hash(const char* name, uint64_t seed) {
+	uint64_t	hash = 14695981039346656037UL ^ seed;
+
+	for ( ; *name != '\0'; name++ ) {
+		hash ^= (unsigned char) *name;
+		hash *= 1099511628211UL;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Canonical hash of a graph, written as hex digits
+ *
+ * @param graph Graph to be hashed
+ * @param key Receives CACHE_KEY_SIZE characters
+ *
+ * @details Every vertex name and every edge, given by the names of its ends,
+ *          is mixed on its own and the results are added, so the hash depends
+ *          on the vertex and edge sets only, not on the order of the input.
+ *          A non-directed edge is hashed with its ends sorted. Two sums with
+ *          different seeds give a 128-bit key.
+ */
+void cache_key(Graph* graph, char* key) {
+	int		n = graph->vertices_amount;
+	uint64_t	*high = (uint64_t*) mem_malloc( sizeof(uint64_t) * n + 1, MEM_SCRATCH ),
+			*low = (uint64_t*) mem_malloc( sizeof(uint64_t) * n + 1, MEM_SCRATCH ),
+			high_sum = cache_mix(CACHE_SEED_HIGH + graph->flag),
+			low_sum = cache_mix(CACHE_SEED_LOW + graph->flag);
+
+	for ( int i = 0; i < n; i++ ) {
+		high[i] = cache_name_hash(graph->vertices[i], CACHE_SEED_HIGH);
+		low[i] = cache_name_hash(graph->vertices[i], CACHE_SEED_LOW);
+		high_sum += cache_mix(high[i]);
+		low_sum += cache_mix(low[i]);
+	}
+
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			int	v = graph->edges_index[u][k];
+
+			if ( graph->flag == NON_DIRECTED ) {
+				if ( v < u ) continue;
+				high_sum += cache_mix(( high[u] < high[v] ? high[u] : high[v] ) * 31 + ( high[u] < high[v] ? high[v] : high[u] ) + 1);
+				low_sum += cache_mix(( low[u] < low[v] ? low[u] : low[v] ) * 31 + ( low[u] < low[v] ? low[v] : low[u] ) + 1);
+			} else {
+				high_sum += cache_mix(high[u] * 31 + high[v] + 2);
+				low_sum += cache_mix(low[u] * 31 + low[v] + 2);
+			}
+		}
+	}
+
+	snprintf(key, CACHE_KEY_SIZE, "%016llx%016llx", (unsigned long long) high_sum, (unsigned long long) low_sum);
+	mem_free(high);
+	mem_free(low);
+}
+
+/**
+ * @brief Path of the entry of a graph for an engine
+ */
+void cache_path(char* path, const char* key, const char* engine) {
+	snprintf(path, CACHE_PATH_SIZE, "%s/%s-%s-v%d%s", cache_directory, key, engine, CACHE_VERSION, CACHE_SUFFIX);
+}
+
+int cache_compare(const void* first, const void* second) {
+	const CacheEntry	*a = (const CacheEntry*) first,
+				*b = (const CacheEntry*) second;
+
+	if ( a->used.tv_sec != b->used.tv_sec ) return a->used.tv_sec < b->used.tv_sec ? -1 : 1;
+	if ( a->used.tv_nsec != b->used.tv_nsec ) return a->used.tv_nsec < b->used.tv_nsec ? -1 : 1;
+	return strcmp(a->name, b->name);
+}
+
+/**
+ * @brief Removes the least recently used entries once the cache is over its budget
+ *
+ * @param added Bytes just written to the cache
+ *
+ * @details The directory is only scanned when the bytes counted since the
+ *          last scan go over cache_budget. Hits refresh the modification time
+ *          of their entry, so the oldest modification time is the least
+ *          recently used entry.
+ */
+void cache_evict(long added) {
+	DIR		*directory = NULL;
+	struct dirent	*entry = NULL;
+	struct stat	info;
+	CacheEntry	*entries = NULL;
+	char		path[CACHE_PATH_SIZE];
+	int		amount = 0,
+			allocated = 0;
+	long		total = 0;
+
+	pthread_mutex_lock(&cache_lock);
+	if ( cache_estimate >= 0 && ( cache_estimate += added ) <= cache_budget ) {
+		pthread_mutex_unlock(&cache_lock);
+		return;
+	}
+
+	if ( ( directory = opendir(cache_directory) ) != NULL ) {
+		while ( ( entry = readdir(directory) ) != NULL ) {
+			size_t	length = strlen(entry->d_name);
+
+			if ( length <= strlen(CACHE_SUFFIX) || strcmp(entry->d_name + length - strlen(CACHE_SUFFIX), CACHE_SUFFIX) != 0 ) continue;
+
+			snprintf(path, CACHE_PATH_SIZE, "%s/%s", cache_directory, entry->d_name);
+			if ( stat(path, &info) != 0 ) continue;
+
+			if ( amount == allocated ) {
+				allocated = allocated == 0 ? 64 : allocated * 2;
+				entries = (CacheEntry*) mem_realloc( entries, sizeof(CacheEntry) * allocated, MEM_SCRATCH );
+			}
+			entries[amount].name = (char*) mem_malloc( length + 1, MEM_SCRATCH );
+			strcpy(entries[amount].name, entry->d_name);
+			entries[amount].size = (long) info.st_size;
+			entries[amount].used = info.st_mtim;
+			total += entries[amount].size;
+			amount++;
+		}
+		closedir(directory);
+	}
+
+	if ( total > cache_budget ) {
+		qsort(entries, amount, sizeof(CacheEntry), cache_compare);
+		for ( int i = 0; i < amount && total > cache_budget; i++ ) {
+			snprintf(path, CACHE_PATH_SIZE, "%s/%s", cache_directory, entries[i].name);
+			if ( unlink(path) == 0 ) total -= entries[i].size;
+		}
+	}
+	cache_estimate = total;
+	pthread_mutex_unlock(&cache_lock);
+
+	for ( int i = 0; i < amount; i++ ) mem_free(entries[i].name);
+	mem_free(entries);
+}
+
+/**
+ * @brief Writes an entry atomically: a temporary file renamed over the entry
+ *
+ * @param key Hash of the graph, see cache_key
+ * @param engine Engine that computed the lists
+ * @param graph Graph giving the vertex names and the direction
+ * @param lists Positions listed for each vertex
+ * @param amounts Number of positions of each vertex
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int cache_write(const char* key, const char* engine, Graph* graph, int** lists, const int* amounts) {
+	char		path[CACHE_PATH_SIZE],
+			temporary[CACHE_PATH_SIZE + 64],
+			name[CACHE_NAME_SIZE];
+	CacheHeader	header;
+	FILE		*file = NULL;
+	int		offset = 0,
+			controller = 0;
+
+	if ( mkdir(cache_directory, 0755) != 0 && access(cache_directory, W_OK) != 0 ) {
+		printf("WARNING: The cache directory (%s) could not be created\n", cache_directory);
+		return -1;
+	}
+
+	cache_path(path, key, engine);
+	snprintf(temporary, sizeof(temporary), "%s.%ld.%lx.tmp", path, (long) getpid(), (unsigned long) pthread_self());
+	if ( ( file = fopen(temporary, "wb") ) == NULL ) {
+		printf("WARNING: The cache entry (%s) could not be written\n", temporary);
+		return -1;
+	}
+
+	memset(&header, 0, sizeof(CacheHeader));
+	memcpy(header.magic, CACHE_MAGIC, 8);
+	header.version = CACHE_VERSION;
+	header.flag = graph->flag;
+	header.vertices_amount = graph->vertices_amount;
+	for ( int i = 0; i < graph->vertices_amount; i++ ) header.entries += amounts[i];
+
+	fwrite(&header, sizeof(CacheHeader), 1, file);
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		memset(name, 0, sizeof(name));
+		strncpy(name, graph->vertices[i], STR_SIZE);
+		fwrite(name, sizeof(name), 1, file);
+	}
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		fwrite(&offset, sizeof(int), 1, file);
+		offset += amounts[i];
+	}
+	fwrite(&offset, sizeof(int), 1, file);
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		if ( amounts[i] > 0 ) fwrite(lists[i], sizeof(int), amounts[i], file);
+	}
+
+	if ( ferror(file) ) controller = -1;
+	if ( fclose(file) != 0 ) controller = -1;
+	if ( controller == 0 && rename(temporary, path) != 0 ) controller = -1;
+
+	if ( controller != 0 ) {
+		printf("WARNING: The cache entry (%s) could not be written\n", path);
+		unlink(temporary);
+		return -1;
+	}
+
+	cache_evict((long) sizeof(CacheHeader) + (long) sizeof(name) * graph->vertices_amount +
+		    (long) sizeof(int) * ( graph->vertices_amount + 1 + header.entries ));
+	return 0;
+}
+
+/**
+ * @brief Reads an entry and matches its vertices with those of a graph
+ *
+ * @param key Hash of the graph, see cache_key
+ * @param engine Engine of the entry
+ * @param graph Graph the entry should describe
+ * @param position Receives the position in graph of each vertex of the entry
+ *
+ * @details Any difference in size, version, direction or vertex names makes
+ *          it a miss. A hit refreshes the modification time of the entry, see
+ *          cache_evict.
+ *
+ * @returns Contents of the entry, NULL on a miss
+ */
+CacheHeader* cache_read(const char* key, const char* engine, Graph* graph, int** position) {
+	char		path[CACHE_PATH_SIZE];
+	FILE		*file = NULL;
+	CacheHeader	*header = NULL;
+	long		size = 0,
+			expected = 0;
+	char		*names = NULL;
+	int		*offsets = NULL,
+			*targets = NULL,
+			n = graph->vertices_amount;
+
+	cache_path(path, key, engine);
+	if ( ( file = fopen(path, "rb") ) == NULL ) return NULL;
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if ( size < (long) sizeof(CacheHeader) ) {
+		fclose(file);
+		return NULL;
+	}
+
+	header = (CacheHeader*) mem_malloc( size, MEM_SCRATCH );
+	if ( fread(header, 1, size, file) != (size_t) size ) size = 0;
+	fclose(file);
+
+	expected = (long) sizeof(CacheHeader) + (long) CACHE_NAME_SIZE * n + (long) sizeof(int) * ( n + 1 + header->entries );
+	if ( size != expected || memcmp(header->magic, CACHE_MAGIC, 8) != 0 || header->version != CACHE_VERSION ||
+	     header->flag != graph->flag || header->vertices_amount != n ) {
+		mem_free(header);
+		return NULL;
+	}
+
+	names = (char*) ( header + 1 );
+	offsets = (int*) ( names + (long) CACHE_NAME_SIZE * n );
+	targets = offsets + n + 1;
+	*position = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+
+	for ( int i = 0; i < n; i++ ) {
+		names[(long) CACHE_NAME_SIZE * i + CACHE_NAME_SIZE - 1] = '\0';
+		( *position )[i] = graph_vertice_finder(graph, names + (long) CACHE_NAME_SIZE * i);
+		if ( ( *position )[i] == -1 || offsets[i] > offsets[i + 1] ) n = -1;
+	}
+	for ( long k = 0; n > 0 && k < header->entries; k++ ) {
+		if ( targets[k] < 0 || targets[k] >= n ) n = -1;
+	}
+	if ( n < 0 || offsets[0] != 0 || offsets[graph->vertices_amount] != header->entries ) {
+		mem_free(*position);
+		mem_free(header);
+		return NULL;
+	}
+
+	utimensat(AT_FDCWD, path, NULL, 0);
+	return header;
+}
+
+/**
+ * @brief Offsets of an entry read by cache_read
+ */
+int* cache_offsets(CacheHeader* header) {
+	return (int*) ( (char*) ( header + 1 ) + (long) CACHE_NAME_SIZE * header->vertices_amount );
+}
+
+/**
+ * @brief Loads the closure of a graph from the cache
+ *
+ * @details Fills the same fields as direct_transitive_closure: the closure
+ *          rows, dense or compressed as closure_storage says, and with dense
+ *          rows the lists of names.
+ *
+ * @returns 0 on a hit, -1 on a miss
+ */
+int cache_load_closure(const char* key, Graph* graph) {
+	int		*position = NULL,
+			*offsets = NULL,
+			*targets = NULL;
+	CacheHeader	*header = cache_read(key, CACHE_CLOSURE, graph, &position);
+
+	if ( header == NULL ) return -1;
+
+	offsets = cache_offsets(header);
+	targets = offsets + graph->vertices_amount + 1;
+
+	free_direct_transitive_closure(graph);
+	if ( graph->closure_storage == CLOSURE_COMPRESSED ) {
+		graph->closure_compressed = (Roaring**) mem_calloc( graph->vertices_amount + 1, sizeof(Roaring*), MEM_CLOSURE );
+		for ( int i = 0; i < graph->vertices_amount; i++ ) graph->closure_compressed[i] = roaring_initializer();
+	} else {
+		graph->closure_rows = bitmatrix_initializer(graph->vertices_amount);
+	}
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		int	p = position[i];
+
+		for ( int k = offsets[i]; k < offsets[i + 1]; k++ ) {
+			int	q = position[targets[k]];
+
+			if ( graph->closure_compressed != NULL ) {
+				roaring_add(graph->closure_compressed[p], q);
+				continue;
+			}
+			graph->transitive_closure[p][k - offsets[i]] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_CLOSURE );
+			strcpy( graph->transitive_closure[p][k - offsets[i]], graph->vertices[q] );
+			bitmatrix_set(graph->closure_rows, p, q);
+		}
+		graph->num_transitive_closure[p] = offsets[i + 1] - offsets[i];
+	}
+
+	if ( graph->closure_compressed != NULL ) {
+		for ( int i = 0; i < graph->vertices_amount; i++ ) roaring_optimize(graph->closure_compressed[i]);
+	}
+
+	mem_free(position);
+	mem_free(header);
+	return 0;
+}
+
+/**
+ * @brief Stores the closure of a graph, computed by direct_transitive_closure
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int cache_store_closure(const char* key, Graph* graph) {
+	int	**lists = (int**) mem_malloc( sizeof(int*) * graph->vertices_amount + 1, MEM_SCRATCH ),
+		controller = 0;
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		lists[i] = (int*) mem_malloc( sizeof(int) * graph->num_transitive_closure[i] + 1, MEM_SCRATCH );
+		if ( graph->closure_compressed != NULL ) {
+			roaring_to_array(graph->closure_compressed[i], lists[i]);
+			continue;
+		}
+		for ( int k = 0; k < graph->num_transitive_closure[i]; k++ ) {
+			lists[i][k] = graph_vertice_finder(graph, graph->transitive_closure[i][k]);
+		}
+	}
+
+	controller = cache_write(key, CACHE_CLOSURE, graph, lists, graph->num_transitive_closure);
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) mem_free(lists[i]);
+	mem_free(lists);
+	return controller;
+}
+
+/**
+ * @brief Loads the reduction of a graph from the cache
+ *
+ * @param key Hash of the graph, see cache_key
+ * @param engine Engine that computed the reduction
+ * @param graph Graph that was reduced, gives the order of the vertices
+ *
+ * @details The reduction is rebuilt with graph_add_edges in the vertex order
+ *          of graph, as the engines would have returned it.
+ *
+ * @returns Reference to newly create Graph, NULL on a miss
+ */
+Graph* cache_load_reduction(const char* key, const char* engine, Graph* graph) {
+	int		*position = NULL,
+			*offsets = NULL,
+			*targets = NULL,
+			*sources = NULL,
+			*destinations = NULL,
+			amount = 0;
+	CacheHeader	*header = cache_read(key, engine, graph, &position);
+	Graph		*g = NULL;
+
+	if ( header == NULL ) return NULL;
+
+	offsets = cache_offsets(header);
+	targets = offsets + graph->vertices_amount + 1;
+	sources = (int*) mem_malloc( sizeof(int) * header->entries + 1, MEM_SCRATCH );
+	destinations = (int*) mem_malloc( sizeof(int) * header->entries + 1, MEM_SCRATCH );
+
+	// A non-directed edge is listed on both vertices but inserted once
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		for ( int k = offsets[i]; k < offsets[i + 1]; k++ ) {
+			if ( graph->flag == NON_DIRECTED && targets[k] < i ) continue;
+			sources[amount] = position[i];
+			destinations[amount] = position[targets[k]];
+			amount++;
+		}
+	}
+
+	if ( ( g = graph_initializer(graph->vertices_amount, amount, graph->flag) ) != NULL ) {
+		g->closure_storage = graph->closure_storage;
+		for ( int i = 0; i < graph->vertices_amount; i++ ) graph_add_vertice(g, graph->vertices[i]);
+		graph_add_edges(g, sources, destinations, amount);
+	}
+
+	mem_free(sources);
+	mem_free(destinations);
+	mem_free(position);
+	mem_free(header);
+	return g;
+}
+
+/**
+ * @brief Stores the reduction of a graph computed by an engine
+ *
+ * @param key Hash of the graph that was reduced, not of the reduction
+ * @param engine Engine that computed the reduction
+ * @param reduced Reduction to be stored
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int cache_store_reduction(const char* key, const char* engine, Graph* reduced) {
+	return cache_write(key, engine, reduced, reduced->edges_index, reduced->edges_neighbours);
+}
@@ -0,0 +1,75 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/cache.h
+ *
+ * @brief Struct of the on-disk cache of closures and reductions
+ *
+ */
+#ifndef CACHE_H_
+#define CACHE_H_
+
+	#include <time.h>
+
+	/**
+	 * @name Cache definitions
+	 */
+	/**@{*/
+	#define CACHE_MAGIC		"TRCACHE1"		/* First bytes of a cache entry */
+	#define CACHE_VERSION		1			/* Version of the engines, bump when a result may change */
+	#define CACHE_KEY_SIZE		33			/* Hex digits of a graph hash, plus the null character */
+	#define CACHE_SUFFIX		".trc"			/* Extension of the entries, nothing else is evicted */
+	#define CACHE_DEFAULT_BUDGET	( 256L << 20 )		/* Bytes of entries kept in the directory */
+	#define CACHE_CLOSURE		"closure"		/* Engine name of closure entries */
+	#define CACHE_NAME_SIZE		( ( STR_SIZE + 8 ) / 8 * 8 )	/* Bytes of a vertex name, rounded so the lists after them stay aligned */
+	/**@}*/
+
+	typedef struct CacheHeader {
+
+		/**
+		 * @name Header of a cache entry
+		 */
+		/**@{*/
+		char	magic[8];		/* CACHE_MAGIC */
+		int	version;		/* CACHE_VERSION that wrote it */
+		int	flag;			/* Direction of the graph */
+		int	vertices_amount;	/* Vertex names that follow */
+		int	padding;
+		long	entries;		/* Positions listed after the offsets */
+		/**@}*/
+
+	} CacheHeader;
+
+	typedef struct CacheEntry {
+
+		/**
+		 * @name Entry found while evicting
+		 */
+		/**@{*/
+		char*		name;			/* File name inside the cache directory */
+		long		size;			/* Bytes of the file */
+		struct timespec	used;			/* Modification time, refreshed by every hit */
+		/**@}*/
+
+	} CacheEntry;
+
+	extern const char* cache_directory;	/* Directory of the cache, NULL when disabled */
+	extern long	   cache_budget;	/* Bytes of entries kept, the least recently used are evicted */
+
+#endif /* CACHE_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Cache operations
+ */
+/**@{*/
+extern void   cache_key(Graph* graph, char* key);
+extern int    cache_load_closure(const char* key, Graph* graph);
+extern int    cache_store_closure(const char* key, Graph* graph);
+extern Graph* cache_load_reduction(const char* key, const char* engine, Graph* graph);
+extern int    cache_store_reduction(const char* key, const char* engine, Graph* reduced);
+/**@}*/
@@ -0,0 +1,170 @@
+#include "graph.h"
+#include "bitset.h"
+#include "walk.h"
+#include "overlay.h"
+#include "chain.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+int chain_max_width = CHAIN_DEFAULT_MAX_WIDTH;
+
+/**
+ * @brief Splits the vertices of a directed acyclic graph into chains
+ *
+ * @param graph Acyclic graph to be iterated
+ * @param max_width Most chains accepted
+ *
+ * @details Greedy path cover: going from the sinks up, a vertex is put in
+ *          front of the chain starting at one of its neighbours, or starts a
+ *          new chain when every neighbour already has a vertex before it.
+ *          Consecutive vertices of a chain are joined by an edge, so whatever
+ *          reaches a vertex of a chain reaches the rest of it. The number of
+ *          chains bounds the width of the graph from above, and is the
+ *          measure used to choose this engine.
+ *
+ * @returns Reference to newly create Chains, NULL if more than max_width chains are needed
+ */
+Chains* chain_decompose(Graph* graph, int max_width) {
+	int	n = graph->vertices_amount,
+		width = 0;
+	int	*order = graph_descendants_first(graph),
+		*chain = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*next = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*first = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH ),
+		*position = NULL;
+	Chains	*chains = NULL;
+
+	for ( int p = 0; p < n && width <= max_width; p++ ) {
+		int	v = order[p];
+
+		next[v] = -1;
+		for ( int k = 0; k < graph->edges_neighbours[v]; k++ ) {
+			int	w = graph->edges_index[v][k];
+
+			if ( first[w] ) {
+				first[w] = 0;
+				next[v] = w;
+				chain[v] = chain[w];
+				break;
+			}
+		}
+
+		if ( next[v] == -1 ) chain[v] = width++;
+		first[v] = 1;
+	}
+
+	if ( width > max_width ) {
+		mem_free(order);
+		mem_free(chain);
+		mem_free(next);
+		mem_free(first);
+		return NULL;
+	}
+
+	// Positions are counted from the first vertex of every chain
+	position = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+	for ( int v = 0; v < n; v++ ) {
+		if ( ! first[v] ) continue;
+
+		for ( int w = v, k = 0; w != -1; w = next[w], k++ ) position[w] = k;
+	}
+
+	chains = (Chains*) mem_malloc( sizeof(Chains), MEM_SCRATCH );
+	chains->width = width;
+	chains->chain = chain;
+	chains->position = position;
+	chains->order = order;
+
+	mem_free(next);
+	mem_free(first);
+	return chains;
+}
+
+/**
+ * @brief Frees a chain decomposition
+ */
+void chain_destroy(Chains* chains) {
+	if ( chains == NULL ) return;
+
+	mem_free(chains->chain);
+	mem_free(chains->position);
+	mem_free(chains->order);
+	mem_free(chains);
+}
+
+/**
+ * @brief Transitive reduction of a directed acyclic graph through a chain decomposition
+ *
+ * @param view Unchanged view of an acyclic directed graph, that will have its redundant edges removed
+ * @param max_width Most chains accepted, see chain_decompose
+ * @param progress Budget and progress of the reduction, NULL for none
+ *
+ * @details With k chains, every vertex keeps for each chain the first position
+ *          it reaches there, which describes its whole closure in k integers.
+ *          Going from the sinks up, the rows of the neighbours of u are merged
+ *          into a cover row; a neighbour v is then redundant exactly when the
+ *          cover reaches its chain at or before its position, as another
+ *          neighbour reaches it. Folding the neighbours themselves into the
+ *          cover gives the row of u. This takes O(k * E) time and O(k * V)
+ *          memory, without any V * V closure, and removes the same edges as
+ *          walk_acyclic.
+ *
+ * @returns 0 if OK, -1 if the graph needs more than max_width chains or the view was changed
+ */
+int chain_reduce(Overlay* view, int max_width, WalkProgress* progress) {
+	Graph	*graph = view->base;
+	Chains	*chains = NULL;
+	int	*reach = NULL,
+		*cover = NULL,
+		k = 0;
+	long	tested = 0,
+		removed = 0;
+
+	// The lists of the base graph are read directly
+	if ( view->deleted.amount > 0 || view->added.amount > 0 ) return -1;
+
+	if ( ( chains = chain_decompose(graph, max_width) ) == NULL ) return -1;
+
+	k = chains->width;
+	reach = (int*) mem_malloc( sizeof(int) * (long) k * graph->vertices_amount + 1, MEM_CLOSURE );
+	cover = (int*) mem_malloc( sizeof(int) * k + 1, MEM_SCRATCH );
+
+	for ( int p = 0; p < graph->vertices_amount; p++ ) {
+		int	u = chains->order[p],
+			*row = reach + (long) k * u;
+
+		for ( int c = 0; c < k; c++ ) cover[c] = CHAIN_NONE;
+
+		// Descendants of the neighbours only, a neighbour never covers itself
+		for ( int e = 0; e < graph->edges_neighbours[u]; e++ ) {
+			int	*neighbour = reach + (long) k * graph->edges_index[u][e];
+
+			for ( int c = 0; c < k; c++ ) {
+				if ( neighbour[c] < cover[c] ) cover[c] = neighbour[c];
+			}
+		}
+
+		memcpy(row, cover, sizeof(int) * k);
+		for ( int e = 0; e < graph->edges_neighbours[u]; e++ ) {
+			int	v = graph->edges_index[u][e],
+				c = chains->chain[v];
+
+			if ( chains->position[v] < row[c] ) row[c] = chains->position[v];
+
+			if ( cover[c] <= chains->position[v] ) {
+				overlay_delete_edge(view, u, v);
+				removed++;
+			}
+		}
+		tested += graph->edges_neighbours[u];
+	}
+
+	walk_progress_step(progress, tested, removed);
+
+	mem_free(reach);
+	mem_free(cover);
+	chain_destroy(chains);
+	return 0;
+}
@@ -0,0 +1,54 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/chain.h
+ *
+ * @brief Struct of a chain decomposition of a directed acyclic graph
+ *
+ */
+#ifndef CHAIN_H_
+#define CHAIN_H_
+
+	/**
+	 * @name Chain definitions
+	 */
+	/**@{*/
+	#define CHAIN_NONE		0x7FFFFFFF	/* Position past the end of every chain, nothing reachable */
+	#define CHAIN_DISABLED		0		/* chain_max_width that keeps walk() off the chain engine */
+	#define CHAIN_DEFAULT_MAX_WIDTH	64		/* Widest decomposition handed to the chain engine */
+	/**@}*/
+
+	struct Overlay;		/* Copy-on-write view of a graph, see overlay.h */
+	struct WalkProgress;	/* Budget and progress of a reduction, see walk.h */
+
+	typedef struct Chains {
+
+		/**
+		 * @name Decomposition of the vertices into paths of the graph
+		 */
+		/**@{*/
+		int	width;			/* Number of chains */
+		int*	chain;			/* Chain of each vertex */
+		int*	position;		/* Position of each vertex in its chain, 0 for its first vertex */
+		int*	order;			/* Vertices with every vertex after all its descendants */
+		/**@}*/
+
+	} Chains;
+
+	extern int chain_max_width;	/* Widest decomposition walk() reduces by chains, CHAIN_DISABLED for none */
+
+#endif /* CHAIN_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Chain operations
+ */
+/**@{*/
+extern Chains* chain_decompose(Graph* graph, int max_width);
+extern void chain_destroy(Chains* chains);
+extern int  chain_reduce(struct Overlay* view, int max_width, struct WalkProgress* progress);
+/**@}*/
@@ -0,0 +1,244 @@
+#include "graph.h"
+#include "overlay.h"
+#include "checkpoint.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+const char* checkpoint_path = NULL;
+double	    checkpoint_interval = CHECKPOINT_INTERVAL;
+
+#define FNV_OFFSET	14695981039346656037UL
+#define FNV_PRIME	1099511628211UL
+
+/**
+ * @brief Adds bytes to a FNV-1a hash
+ */
+uint64_t checkpoint_hash_bytes(uint64_t hash, const void* bytes, size_t size) {
+	for ( size_t i = 0; i < size; i++ ) {
+		hash ^= ( (const unsigned char*) bytes )[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+/**
+ * @brief Hash of a graph as read from its input
+ *
+ * @details Covers the direction flag, the vertex names in order and every
+ *          list of neighbours in order, which is everything a cursor of the
+ *          reduction engines depends on.
+ */
+uint64_t checkpoint_graph_hash(Graph* graph) {
+	uint64_t	hash = FNV_OFFSET;
+
+	hash = checkpoint_hash_bytes(hash, &graph->flag, sizeof(int));
+	hash = checkpoint_hash_bytes(hash, &graph->vertices_amount, sizeof(int));
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		hash = checkpoint_hash_bytes(hash, graph->vertices[i], strlen(graph->vertices[i]) + 1);
+		hash = checkpoint_hash_bytes(hash, &graph->edges_neighbours[i], sizeof(int));
+		hash = checkpoint_hash_bytes(hash, graph->edges_index[i], sizeof(int) * graph->edges_neighbours[i]);
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Monotonic time in seconds
+ */
+double checkpoint_clock(void) {
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Reads the committed records of a checkpoint file
+ *
+ * @details Records after the last cursor belong to work that was not
+ *          committed; they are dropped and the file is cut after the last
+ *          cursor, so new records follow committed ones.
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int checkpoint_replay(Checkpoint* checkpoint, FILE* file, int engine, Graph* graph) {
+	CheckpointHeader	header;
+	CheckpointRecord	record;
+	int	amount = 0,
+		allocated = 0;
+	long	end = sizeof(CheckpointHeader);
+
+	if ( fread(&header, sizeof(CheckpointHeader), 1, file) != 1 || memcmp(header.magic, CHECKPOINT_MAGIC, 8) != 0 ) {
+		printf("ERROR: The file (%s) is not a checkpoint\n", checkpoint->path);
+		return -1;
+	}
+	if ( header.engine != engine || header.vertices_amount != graph->vertices_amount || header.hash != checkpoint_graph_hash(graph) ) {
+		printf("ERROR: The checkpoint (%s) was written for another input or engine, it will not be resumed\n", checkpoint->path);
+		return -1;
+	}
+
+	while ( fread(&record, sizeof(CheckpointRecord), 1, file) == 1 ) {
+		if ( record.kind == CHECKPOINT_REMOVED ) {
+			if ( amount == allocated ) {
+				allocated = allocated == 0 ? 64 : allocated * 2;
+				checkpoint->removed_source = (int*) mem_realloc( checkpoint->removed_source, sizeof(int) * allocated, MEM_SCRATCH );
+				checkpoint->removed_destination = (int*) mem_realloc( checkpoint->removed_destination, sizeof(int) * allocated, MEM_SCRATCH );
+			}
+			checkpoint->removed_source[amount] = record.source;
+			checkpoint->removed_destination[amount] = (int) record.value;
+			amount++;
+		} else if ( record.kind == CHECKPOINT_CURSOR ) {
+			checkpoint->resume = record.value;
+			checkpoint->removed_amount = amount;
+			end = ftell(file);
+		} else {
+			break;
+		}
+	}
+
+	if ( ftruncate(fileno(file), end) != 0 ) {
+		printf("ERROR: The checkpoint (%s) could not be cut after its last commit\n", checkpoint->path);
+		return -1;
+	}
+	fseek(file, end, SEEK_SET);
+	return 0;
+}
+
+/**
+ * @brief Opens the checkpoint of a reduction, creating it if needed
+ *
+ * @param path Checkpoint file
+ * @param engine Engine that writes the checkpoint, one of the CHECKPOINT_* engines
+ * @param graph Input graph of the reduction
+ *
+ * @details An existing file is only resumed when it was written by the same
+ *          engine for the same input, see checkpoint_graph_hash.
+ *
+ * @returns Reference to newly create Checkpoint, NULL on ERROR
+ */
+Checkpoint* checkpoint_open(const char* path, int engine, Graph* graph) {
+	Checkpoint	*checkpoint = (Checkpoint*) mem_calloc( 1, sizeof(Checkpoint), MEM_SCRATCH );
+	FILE	*file = fopen(path, "r+b");
+
+	checkpoint->path = (char*) mem_malloc( strlen(path) + 1, MEM_SCRATCH );
+	strcpy(checkpoint->path, path);
+	checkpoint->interval = checkpoint_interval;
+
+	if ( file != NULL ) {
+		if ( checkpoint_replay(checkpoint, file, engine, graph) != 0 ) {
+			fclose(file);
+			checkpoint->file = NULL;
+			checkpoint_close(checkpoint, 0);
+			return NULL;
+		}
+		printf("Resuming from checkpoint (%s): %d edges removed, cursor at %ld\n", path, checkpoint->removed_amount, checkpoint->resume);
+	} else {
+		CheckpointHeader	header;
+
+		if ( ( file = fopen(path, "w+b") ) == NULL ) {
+			printf("ERROR: The checkpoint (%s) could not be created\n", path);
+			checkpoint_close(checkpoint, 0);
+			return NULL;
+		}
+
+		memset(&header, 0, sizeof(CheckpointHeader));
+		memcpy(header.magic, CHECKPOINT_MAGIC, 8);
+		header.engine = engine;
+		header.vertices_amount = graph->vertices_amount;
+		header.hash = checkpoint_graph_hash(graph);
+		fwrite(&header, sizeof(CheckpointHeader), 1, file);
+		fflush(file);
+	}
+
+	checkpoint->buffer = (char*) mem_malloc( CHECKPOINT_BUFFER, MEM_SCRATCH );
+	setvbuf(file, checkpoint->buffer, _IOFBF, CHECKPOINT_BUFFER);
+	checkpoint->file = file;
+	checkpoint->cursor = checkpoint->resume;
+	checkpoint->committed = checkpoint_clock();
+	return checkpoint;
+}
+
+/**
+ * @brief Removes from a view the edges a checkpoint committed
+ */
+void checkpoint_restore(Checkpoint* checkpoint, Overlay* view) {
+	if ( checkpoint == NULL ) return;
+
+	for ( int i = 0; i < checkpoint->removed_amount; i++ ) {
+		overlay_delete_edge(view, checkpoint->removed_source[i], checkpoint->removed_destination[i]);
+	}
+}
+
+/**
+ * @brief Cursor the engine resumes from, 0 without checkpoint
+ */
+long checkpoint_resume(Checkpoint* checkpoint) {
+	return checkpoint != NULL ? checkpoint->resume : 0;
+}
+
+/**
+ * @brief Records an edge removed by the engine
+ *
+ * @details The record only counts once a later cursor is committed
+ */
+void checkpoint_removed(Checkpoint* checkpoint, int source, int destination) {
+	CheckpointRecord	record = { CHECKPOINT_REMOVED, source, destination };
+
+	if ( checkpoint == NULL ) return;
+
+	fwrite(&record, sizeof(CheckpointRecord), 1, checkpoint->file);
+}
+
+/**
+ * @brief Writes the cursor and the records before it to the file
+ */
+void checkpoint_commit(Checkpoint* checkpoint) {
+	CheckpointRecord	record = { CHECKPOINT_CURSOR, 0, checkpoint->cursor };
+
+	fwrite(&record, sizeof(CheckpointRecord), 1, checkpoint->file);
+	fflush(checkpoint->file);
+	checkpoint->committed = checkpoint_clock();
+}
+
+/**
+ * @brief Moves the cursor of the engine
+ *
+ * @param checkpoint Checkpoint of the reduction, NULL for none
+ * @param cursor Work done so far; resuming skips it
+ *
+ * @details The engine calls it after each unit of work, whose removals are
+ *          already recorded. It commits once every interval seconds, so the
+ *          file only grows by the removed edges and one cursor per commit.
+ */
+void checkpoint_cursor(Checkpoint* checkpoint, long cursor) {
+	if ( checkpoint == NULL ) return;
+
+	checkpoint->cursor = cursor;
+	if ( checkpoint_clock() - checkpoint->committed >= checkpoint->interval ) checkpoint_commit(checkpoint);
+}
+
+/**
+ * @brief Commits and closes a checkpoint
+ *
+ * @param checkpoint Checkpoint to be closed
+ * @param finished 1 if the reduction finished, its file is then removed
+ */
+void checkpoint_close(Checkpoint* checkpoint, int finished) {
+	if ( checkpoint == NULL ) return;
+
+	if ( checkpoint->file != NULL ) {
+		checkpoint_commit(checkpoint);
+		fclose(checkpoint->file);
+		if ( finished ) unlink(checkpoint->path);
+	}
+
+	mem_free(checkpoint->buffer);
+	mem_free(checkpoint->path);
+	mem_free(checkpoint->removed_source);
+	mem_free(checkpoint->removed_destination);
+	mem_free(checkpoint);
+}
@@ -0,0 +1,106 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/checkpoint.h
+ *
+ * @brief Struct of a journal that lets a reduction resume after being stopped
+ *
+ */
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+	#include <stdio.h>
+	#include <stdint.h>
+
+	/**
+	 * @name Checkpoint definitions
+	 */
+	/**@{*/
+	#define CHECKPOINT_MAGIC		"TRCHECK1"	/* First bytes of a checkpoint file */
+	#define CHECKPOINT_INTERVAL		10.0		/* Seconds between two commits */
+	#define CHECKPOINT_BUFFER		( 1 << 16 )	/* Bytes buffered before records reach the file */
+	#define CHECKPOINT_REMOVED		1		/* Record of an edge removed */
+	#define CHECKPOINT_CURSOR		2		/* Record of the cursor, commits every record before it */
+	#define CHECKPOINT_WALK_EDGES		1		/* Engine walk_edges, cursor over the edges */
+	#define CHECKPOINT_WALK_ACYCLIC		2		/* Engine walk_acyclic, cursor over the vertices */
+	#define CHECKPOINT_WALK_EXTERNAL	3		/* Engine walk_external, cursor over the closure file order */
+	#define CHECKPOINT_PERMUTATION		4		/* Engine permutation, cursor over the pairs of vertices */
+	/**@}*/
+
+	struct Overlay;		/* Copy-on-write view of a graph, see overlay.h */
+
+	typedef struct CheckpointHeader {
+
+		/**
+		 * @name First bytes of a checkpoint file
+		 */
+		/**@{*/
+		char		magic[8];		/* CHECKPOINT_MAGIC */
+		int		engine;			/* One of the CHECKPOINT_WALK_* or CHECKPOINT_PERMUTATION values */
+		int		vertices_amount;	/* Number of vertices of the input graph */
+		uint64_t	hash;			/* checkpoint_graph_hash of the input graph */
+		/**@}*/
+
+	} CheckpointHeader;
+
+	typedef struct CheckpointRecord {
+
+		/**
+		 * @name Delta appended to a checkpoint file
+		 */
+		/**@{*/
+		int	kind;			/* CHECKPOINT_REMOVED or CHECKPOINT_CURSOR */
+		int	source;			/* Source of the edge removed */
+		long	value;			/* Destination of the edge removed, or the cursor */
+		/**@}*/
+
+	} CheckpointRecord;
+
+	typedef struct Checkpoint {
+
+		/**
+		 * @name Journal file
+		 */
+		/**@{*/
+		FILE*	file;			/* Opened for appending records */
+		char*	path;			/* Name of the file */
+		char*	buffer;			/* Buffer of the file */
+		double	interval;		/* Seconds between two commits */
+		double	committed;		/* Time of the last commit */
+		long	cursor;			/* Work done, as counted by the engine */
+		/**@}*/
+
+		/**
+		 * @name State read back when resuming
+		 */
+		/**@{*/
+		long	resume;			/* Cursor of the last commit, 0 for a new checkpoint */
+		int*	removed_source;		/* Edges removed before the last commit, in order */
+		int*	removed_destination;
+		int	removed_amount;
+		/**@}*/
+
+	} Checkpoint;
+
+	extern const char* checkpoint_path;	/* Checkpoint used by walk() and permutation(), NULL for none */
+	extern double	   checkpoint_interval;	/* Seconds between two commits of their checkpoints */
+
+#endif /* CHECKPOINT_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Checkpoint operations
+ */
+/**@{*/
+extern uint64_t checkpoint_graph_hash(Graph* graph);
+extern Checkpoint* checkpoint_open(const char* path, int engine, Graph* graph);
+extern void checkpoint_restore(Checkpoint* checkpoint, struct Overlay* view);
+extern long checkpoint_resume(Checkpoint* checkpoint);
+extern void checkpoint_removed(Checkpoint* checkpoint, int source, int destination);
+extern void checkpoint_cursor(Checkpoint* checkpoint, long cursor);
+extern void checkpoint_close(Checkpoint* checkpoint, int finished);
+/**@}*/
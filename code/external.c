@@ -0,0 +1,232 @@
+#include "graph.h"
+#include "bitset.h"
+#include "kernels.h"
+#include "external.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+long	    external_budget = EXTERNAL_DEFAULT_BUDGET;
+const char* external_path = EXTERNAL_DEFAULT_PATH;
+
+/**
+ * @brief Bytes before the first row of a closure file of n vertices
+ */
+size_t external_header_size(int n) {
+	size_t	size = sizeof(char) * 8 + sizeof(int) * ( 2 + (size_t) n );
+
+	return ( size + EXTERNAL_PAGE - 1 ) / EXTERNAL_PAGE * EXTERNAL_PAGE;
+}
+
+/**
+ * @brief Maps a closure file and fills the fields of the closure
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int external_closure_map(ExternalClosure* closure, const char* path, int writable) {
+	closure->fd = open(path, writable ? ( O_RDWR | O_CREAT | O_TRUNC ) : O_RDONLY, 0644);
+	if ( closure->fd < 0 ) {
+		printf("ERROR: The closure file (%s) could not be opened\n", path);
+		return -1;
+	}
+
+	if ( writable ) {
+		if ( ftruncate(closure->fd, (off_t) closure->map_size) != 0 ) {
+			printf("ERROR: The closure file (%s) could not be resized to %zu bytes\n", path, closure->map_size);
+			close(closure->fd);
+			return -1;
+		}
+	} else {
+		closure->map_size = (size_t) lseek(closure->fd, 0, SEEK_END);
+	}
+
+	closure->map = mmap(NULL, closure->map_size, writable ? ( PROT_READ | PROT_WRITE ) : PROT_READ, MAP_SHARED, closure->fd, 0);
+	if ( closure->map == MAP_FAILED ) {
+		printf("ERROR: The closure file (%s) could not be mapped\n", path);
+		close(closure->fd);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Computes the transitive closure of an acyclic graph into a memory-mapped file
+ *
+ * @param graph Acyclic graph to be iterated
+ * @param path File that receives the closure, replaced if it exists
+ * @param budget Bytes of closure rows allowed in memory
+ *
+ * @details The vertices are taken descendants first and split in bands of
+ *          consecutive vertices, so the row of every neighbour is complete
+ *          before the rows that need it. Half of the budget holds the band
+ *          being computed; once finished, the band is written to the file and
+ *          dropped from memory. The other half caches rows of earlier bands
+ *          that still have predecessors to be computed, every other row is
+ *          read back from the file.
+ *
+ * @returns Reference to newly create ExternalClosure, NULL on ERROR
+ */
+ExternalClosure* external_closure_build(Graph* graph, const char* path, long budget) {
+	ExternalClosure	*closure = (ExternalClosure*) mem_malloc( sizeof(ExternalClosure), MEM_CLOSURE );
+	int	n = graph->vertices_amount,
+		words = ( n + WORD_BITS - 1 ) / WORD_BITS;
+	size_t	row_bytes = sizeof(WORD) * words,
+		header = external_header_size(n);
+	long	band_rows = row_bytes > 0 ? budget / 2 / (long) row_bytes : 1,
+		cache_rows = band_rows;
+
+	if ( band_rows > n ) band_rows = n;
+	if ( band_rows < 1 ) band_rows = 1;
+	if ( cache_rows > n ) cache_rows = n;
+
+	closure->rows = n;
+	closure->words_per_row = words;
+	closure->map_size = header + row_bytes * n;
+	if ( external_closure_map(closure, path, 1) != 0 ) {
+		mem_free(closure);
+		return NULL;
+	}
+
+	closure->order = graph_descendants_first(graph);
+	closure->position = (int*) mem_malloc( sizeof(int) * n + 1, MEM_CLOSURE );
+	for ( int p = 0; p < n; p++ ) closure->position[closure->order[p]] = p;
+
+	memcpy(closure->map, EXTERNAL_MAGIC, 8);
+	((int*) ( (char*) closure->map + 8 ))[0] = n;
+	((int*) ( (char*) closure->map + 8 ))[1] = words;
+	memcpy((char*) closure->map + 8 + sizeof(int) * 2, closure->order, sizeof(int) * n);
+	closure->data = (WORD*) ( (char*) closure->map + header );
+
+	// Number of predecessors whose row is not computed yet
+	int	*pending = (int*) mem_calloc( n + 1, sizeof(int), MEM_CLOSURE ),
+		*cache_slot = (int*) mem_malloc( sizeof(int) * n + 1, MEM_CLOSURE ),
+		*free_slots = (int*) mem_malloc( sizeof(int) * cache_rows + 1, MEM_CLOSURE ),
+		free_amount = 0;
+	WORD	*cache = (WORD*) mem_malloc( row_bytes * cache_rows + 1, MEM_CLOSURE ),
+		*band = (WORD*) mem_malloc( row_bytes * band_rows + 1, MEM_CLOSURE );
+
+	for ( int u = 0; u < n; u++ ) {
+		cache_slot[u] = -1;
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) pending[graph->edges_index[u][k]]++;
+	}
+	for ( long s = cache_rows - 1; s >= 0; s-- ) free_slots[free_amount++] = (int) s;
+
+	for ( int start = 0; start < n; start += band_rows ) {
+		int	end = ( n - start < band_rows ) ? n : start + (int) band_rows;
+
+		for ( int p = start; p < end; p++ ) {
+			int	u = closure->order[p];
+			WORD	*row = band + (size_t) ( p - start ) * words;
+
+			memset(row, 0, row_bytes);
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+				int	w = graph->edges_index[u][k];
+				WORD	*source = NULL;
+
+				if ( closure->position[w] >= start ) {
+					source = band + (size_t) ( closure->position[w] - start ) * words;
+				} else if ( cache_slot[w] >= 0 ) {
+					source = cache + (size_t) cache_slot[w] * words;
+				} else {
+					source = closure->data + (size_t) closure->position[w] * words;
+				}
+				kernels.row_union(row, source, words);
+				row[w / WORD_BITS] |= (WORD) 1 << ( w % WORD_BITS );
+
+				// Last predecessor of w computed, its row is no longer needed in memory
+				if ( --pending[w] == 0 && cache_slot[w] >= 0 ) {
+					free_slots[free_amount++] = cache_slot[w];
+					cache_slot[w] = -1;
+				}
+			}
+		}
+
+		memcpy(closure->data + (size_t) start * words, band, row_bytes * ( end - start ));
+		for ( int p = start; p < end; p++ ) {
+			int	u = closure->order[p];
+
+			if ( pending[u] > 0 && free_amount > 0 ) {
+				cache_slot[u] = free_slots[--free_amount];
+				memcpy(cache + (size_t) cache_slot[u] * words, band + (size_t) ( p - start ) * words, row_bytes);
+			}
+		}
+
+		// Hand the finished band to the kernel so its pages leave the process
+		char	*first = (char*) ( closure->data + (size_t) start * words ),
+			*last = (char*) ( closure->data + (size_t) end * words ),
+			*aligned = (char*) closure->map + ( first - (char*) closure->map ) / EXTERNAL_PAGE * EXTERNAL_PAGE;
+		msync(aligned, last - aligned, MS_ASYNC);
+		madvise(aligned, last - aligned, MADV_DONTNEED);
+	}
+
+	mem_free(pending);
+	mem_free(cache_slot);
+	mem_free(free_slots);
+	mem_free(cache);
+	mem_free(band);
+	return closure;
+}
+
+/**
+ * @brief Opens a closure file written by external_closure_build
+ *
+ * @param path File to be opened
+ *
+ * @returns Reference to newly create ExternalClosure, NULL on ERROR
+ */
+ExternalClosure* external_closure_open(const char* path) {
+	ExternalClosure	*closure = (ExternalClosure*) mem_malloc( sizeof(ExternalClosure), MEM_CLOSURE );
+	int	*header = NULL;
+
+	if ( external_closure_map(closure, path, 0) != 0 ) {
+		mem_free(closure);
+		return NULL;
+	}
+
+	header = (int*) ( (char*) closure->map + 8 );
+	if ( closure->map_size < external_header_size(0) || memcmp(closure->map, EXTERNAL_MAGIC, 8) != 0 ||
+	     closure->map_size < external_header_size(header[0]) + sizeof(WORD) * (size_t) header[0] * header[1] ) {
+		printf("ERROR: The file (%s) is not a closure file\n", path);
+		munmap(closure->map, closure->map_size);
+		close(closure->fd);
+		mem_free(closure);
+		return NULL;
+	}
+
+	closure->rows = header[0];
+	closure->words_per_row = header[1];
+	closure->order = (int*) mem_malloc( sizeof(int) * closure->rows + 1, MEM_CLOSURE );
+	closure->position = (int*) mem_malloc( sizeof(int) * closure->rows + 1, MEM_CLOSURE );
+	memcpy(closure->order, header + 2, sizeof(int) * closure->rows);
+	for ( int p = 0; p < closure->rows; p++ ) closure->position[closure->order[p]] = p;
+	closure->data = (WORD*) ( (char*) closure->map + external_header_size(closure->rows) );
+
+	// Reduction engines read the rows in file order
+	madvise(closure->map, closure->map_size, MADV_SEQUENTIAL);
+	return closure;
+}
+
+/**
+ * @brief Returns the closure row of a vertex, read from the file on demand
+ */
+WORD* external_closure_row(ExternalClosure* closure, int vertice) {
+	return closure->data + (size_t) closure->position[vertice] * closure->words_per_row;
+}
+
+/**
+ * @brief Unmaps a closure file, the file itself is kept
+ */
+void external_closure_close(ExternalClosure* closure) {
+	if ( closure == NULL ) return;
+
+	munmap(closure->map, closure->map_size);
+	close(closure->fd);
+	mem_free(closure->order);
+	mem_free(closure->position);
+	mem_free(closure);
+}
@@ -0,0 +1,68 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/external.h
+ *
+ * @brief Struct of a transitive closure kept in a memory-mapped file
+ *
+ */
+#ifndef EXTERNAL_H_
+#define EXTERNAL_H_
+
+	#include <stddef.h>
+	#include <limits.h>
+
+	/**
+	 * @name External closure definitions
+	 */
+	/**@{*/
+	#define EXTERNAL_MAGIC			"TRCLOSE1"		/* First bytes of a closure file */
+	#define EXTERNAL_PAGE			4096			/* Rows start at a multiple of this offset */
+	#define EXTERNAL_DEFAULT_BUDGET		( 64L << 10 )		/* Bytes of closure rows kept in memory, about half the rows of MAX_AMOUNT vertices */
+	#define EXTERNAL_DEFAULT_PATH		"closure.bin"		/* File used by walk() for the external closure */
+	#define EXTERNAL_DISABLED		LONG_MAX		/* Budget with which walk() never goes to disk */
+	/**@}*/
+
+	typedef struct ExternalClosure {
+
+		/**
+		 * @name Closure information
+		 */
+		/**@{*/
+		int	rows;			/* Number of vertices */
+		int	words_per_row;		/* Number of WORDs of each row */
+		int*	order;			/* Vertex stored at each row of the file, descendants first */
+		int*	position;		/* Row of the file of each vertex */
+		/**@}*/
+
+		/**
+		 * @name File information
+		 */
+		/**@{*/
+		int	fd;			/* Descriptor of the closure file */
+		void*	map;			/* Whole file mapped in memory */
+		size_t	map_size;		/* Size of the file */
+		WORD*	data;			/* First row inside the mapping */
+		/**@}*/
+
+	} ExternalClosure;
+
+	extern long	  external_budget;	/* Closures bigger than this many bytes are computed by walk() on disk */
+	extern const char* external_path;	/* File walk() uses for them */
+
+#endif /* EXTERNAL_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name External closure operations
+ */
+/**@{*/
+extern ExternalClosure* external_closure_build(Graph* graph, const char* path, long budget);
+extern ExternalClosure* external_closure_open(const char* path);
+extern WORD* external_closure_row(ExternalClosure* closure, int vertice);
+extern void  external_closure_close(ExternalClosure* closure);
+/**@}*/
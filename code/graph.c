@@ -1,5 +1,8 @@
 #include "graph.h"
-#include "stack.h"
+#include "bitset.h"
+#include "roaring.h"
+#include "lazy_closure.h"
+#include "memtrack.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -22,19 +25,32 @@ Graph* graph_initializer(int number_of_vertices, int number_of_edges, int flag){
 		return NULL;
 	}
 
-	Graph	*g = (Graph*) malloc( sizeof(Graph) );
+	Graph	*g = (Graph*) mem_malloc( sizeof(Graph), MEM_GRAPH );
 
-	g->vertices = (STRING*) malloc( sizeof(STRING) * number_of_vertices + 1 );
+	g->vertices = (STRING*) mem_malloc( sizeof(STRING) * number_of_vertices + 1, MEM_GRAPH );
 	g->vertices_allocated = number_of_vertices;
+	g->vertices_amount = 0;
 
-	g->edges = (STRING**) malloc( sizeof(STRING*) * number_of_vertices + 1 );
+	g->edges = (STRING**) mem_malloc( sizeof(STRING*) * number_of_vertices + 1, MEM_GRAPH );
 	g->edges_allocated = number_of_edges;
+	g->edges_amount = 0;
 
-	g->edges_neighbours = (int*) calloc( number_of_vertices, sizeof(int) );
+	g->edges_neighbours = (int*) mem_calloc( number_of_vertices, sizeof(int), MEM_GRAPH );
 
-	g->transitive_closure = (STRING**) malloc( sizeof(STRING*) * number_of_vertices + 1 );
+	// At most half full, so a lookup stops after a few slots
+	for ( g->vertices_table_size = 2; g->vertices_table_size < 2 * ( number_of_vertices + 1 ); g->vertices_table_size *= 2 );
+	g->vertices_table = (int*) mem_malloc( sizeof(int) * g->vertices_table_size, MEM_GRAPH );
+	memset(g->vertices_table, -1, sizeof(int) * g->vertices_table_size);
 
-	g->num_transitive_closure = (int*) calloc( number_of_vertices, sizeof(int) );
+	g->edges_index = (int**) mem_malloc( sizeof(int*) * number_of_vertices + 1, MEM_GRAPH );
+
+	g->transitive_closure = (STRING**) mem_malloc( sizeof(STRING*) * number_of_vertices + 1, MEM_CLOSURE );
+
+	g->num_transitive_closure = (int*) mem_calloc( number_of_vertices, sizeof(int), MEM_CLOSURE );
+	g->closure_rows = NULL;
+	g->closure_compressed = NULL;
+	g->closure_lazy = NULL;
+	g->closure_storage = CLOSURE_DENSE;
 
 	g->flag = flag;
 
@@ -48,39 +64,56 @@ Graph* graph_clone(Graph *g){
 	}
 
 	Graph	*cloned = graph_initializer(g->vertices_amount, g->edges_amount, g->flag);
-	int	pos_first  =  0,
-		pos_second =  0,
-		first_neighbours_amount = 0;
+	int	*sources = (int*) mem_malloc( sizeof(int) * g->edges_amount + 1, MEM_SCRATCH ),
+		*destinations = (int*) mem_malloc( sizeof(int) * g->edges_amount + 1, MEM_SCRATCH ),
+		amount = 0;
+
+	cloned->closure_storage = g->closure_storage;
 
 	for (int i = 0; i < g->vertices_amount; i++ ) {
 		graph_add_vertice(cloned, g->vertices[i]);
 	}
 
-	for ( pos_first = 0; pos_first < g->vertices_amount; pos_first++ ) {
-		for( pos_second = 0; pos_second < g->edges_neighbours[pos_first]; pos_second++ ) {
-
-			first_neighbours_amount = cloned->edges_neighbours[pos_first];
-		
-			// Other vertice is already inserted
-			if ( graph_edge_finder(cloned, pos_first, g->edges[pos_first][pos_second]) != -1 ) {
-				printf("ERROR: Your destination vertice (%s) is already inserted in List of Neighbours of source (%s)\n", g->edges[pos_first][pos_second], g->vertices[pos_first]);
-			} else {
-				// Alocatting line on demand
-				cloned->edges[pos_first][first_neighbours_amount] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-
-				// Inserting value on line
-				strcpy( cloned->edges[pos_first][first_neighbours_amount], g->edges[pos_first][pos_second]);
-				
-				// Incrementing number of neighbours that given vertice has
-				cloned->edges_neighbours[pos_first] += 1;
-			}
+	// A non-directed edge is stored on both vertices but inserted once
+	for ( int u = 0; u < g->vertices_amount; u++ ) {
+		for ( int k = 0; k < g->edges_neighbours[u]; k++ ) {
+			if ( g->flag == NON_DIRECTED && g->edges_index[u][k] < u ) continue;
+			sources[amount] = u;
+			destinations[amount] = g->edges_index[u][k];
+			amount++;
 		}
 	}
-	
+	graph_add_edges(cloned, sources, destinations, amount);
+
+	mem_free(sources);
+	mem_free(destinations);
 	return cloned;
 }
 
 
+/**
+ * @brief Slot of vertices_table holding a name, or the free slot where it would go
+ *
+ * @details FNV-1a hash of the name with linear probing. The table is never
+ *          more than half full, see graph_initializer.
+ */
+int graph_vertice_slot(Graph* graph, const char* vertice) {
+	unsigned int	hash = 2166136261u,
+			mask = (unsigned int) graph->vertices_table_size - 1;
+	int		position = 0;
+
+	for ( const char* c = vertice; *c != '\0'; c++ ) {
+		hash ^= (unsigned char) *c;
+		hash *= 16777619u;
+	}
+
+	for ( hash &= mask; ( position = graph->vertices_table[hash] ) != -1; hash = ( hash + 1 ) & mask ) {
+		if ( strcmp(graph->vertices[position], vertice) == 0 ) break;
+	}
+
+	return (int) hash;
+}
+
 /**
  * @brief Insert given vertice into graph
  *
@@ -111,16 +144,50 @@ int graph_add_vertice(Graph* graph, STRING vertice){
 	position = graph->vertices_amount;
 
 	// Alocatting memory on demand
-	graph->vertices[position] = (STRING) malloc( sizeof(char) * STR_SIZE + 1);
+	graph->vertices[position] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_GRAPH);
 	strcpy( graph->vertices[position], vertice );
 	graph->vertices_amount++;
 
-	graph->edges[position] = (STRING*) malloc( sizeof(STRING) * graph->vertices_allocated );
-	graph->transitive_closure[position] = (STRING*) malloc( sizeof(STRING) * graph->vertices_allocated );
+	// The name is not in the table yet, so its slot is the free one the lookup stopped at
+	graph->vertices_table[graph_vertice_slot(graph, vertice)] = position;
+
+	graph->edges[position] = (STRING*) mem_malloc( sizeof(STRING) * graph->vertices_allocated, MEM_GRAPH );
+	graph->edges_index[position] = (int*) mem_malloc( sizeof(int) * graph->vertices_allocated, MEM_GRAPH );
+	graph->transitive_closure[position] = (STRING*) mem_malloc( sizeof(STRING) * graph->vertices_allocated, MEM_CLOSURE );
 	
 	return position;
 }
 
+/**
+ * @brief Inserts a neighbour at its place in a sorted list of neighbours
+ *
+ * @param graph Graph to have the new neighbour
+ * @param vertice Position of the vertice receiving the neighbour
+ * @param neighbour Position of the neighbour, not in the list yet
+ *
+ * @details Lists of neighbours are sorted by position so that graph_has_edge
+ *          can search them by bisection. The larger neighbours are moved one
+ *          place to the right.
+ */
+void graph_insert_neighbour(Graph* graph, int vertice, int neighbour) {
+	int	position = graph->edges_neighbours[vertice];
+
+	// Rows computed on demand describe the edges they were computed from
+	lazy_closure_destroy(graph->closure_lazy);
+	graph->closure_lazy = NULL;
+
+	while ( position > 0 && graph->edges_index[vertice][position - 1] > neighbour ) {
+		graph->edges[vertice][position] = graph->edges[vertice][position - 1];
+		graph->edges_index[vertice][position] = graph->edges_index[vertice][position - 1];
+		position--;
+	}
+
+	graph->edges[vertice][position] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_GRAPH );
+	strcpy( graph->edges[vertice][position], graph->vertices[neighbour] );
+	graph->edges_index[vertice][position] = neighbour;
+	graph->edges_neighbours[vertice] += 1;
+}
+
 /**
  * @brief Insert edges on given vertices
  *
@@ -154,48 +221,152 @@ int graph_add_edge(Graph* graph, const char* first_vertice, const char* second_v
 
 	// Non-direct graph 
 	if ( graph->flag == NON_DIRECTED ) {
-		int	first_neighbours_amount = graph->edges_neighbours[pos_first], 
-			second_neighbours_amount = graph->edges_neighbours[pos_second];
-
 		// Atleast one of the vertices is already inserted
 		if( graph_edge_finder(graph, pos_first, second_vertice) != -1 || graph_edge_finder(graph, pos_second, first_vertice) != -1 ){
 			printf("ERROR: One of your vertices (%s %s) was already inserted in List of Neighbours\n", first_vertice, second_vertice);
 			return controller;
 		}
 
-		// Alocatting lines on demand
-		graph->edges[pos_first][first_neighbours_amount]   = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-		graph->edges[pos_second][second_neighbours_amount] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-
-		// Inserting values on lines
-		strcpy( graph->edges[pos_first][first_neighbours_amount], second_vertice );
-		strcpy( graph->edges[pos_second][second_neighbours_amount], first_vertice );
-
-		// Incrementing number of neighbours that given vertice has
-		graph->edges_neighbours[pos_first] += 1;
-		graph->edges_neighbours[pos_second] += 1;
+		// Inserting values on lines, keeping both lists sorted
+		graph_insert_neighbour(graph, pos_first, pos_second);
+		graph_insert_neighbour(graph, pos_second, pos_first);
 
 	} else {
-		int	first_neighbours_amount = graph->edges_neighbours[pos_first];
-		
 		// Other vertice is already inserted
 		if ( graph_edge_finder(graph, pos_first, second_vertice) != -1 ) {
 			printf("ERROR: Your destination vertice (%s) is already inserted in List of Neighbours of source (%s)\n", second_vertice, first_vertice);
 			return controller;
 		}
-		// Alocatting line on demand
-		graph->edges[pos_first][first_neighbours_amount] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-
-		// Inserting value on line
-		strcpy( graph->edges[pos_first][first_neighbours_amount], second_vertice );
-		
-		// Incrementing number of neighbours that given vertice has
-		graph->edges_neighbours[pos_first] += 1;
+		// Inserting value on line, keeping the list sorted
+		graph_insert_neighbour(graph, pos_first, pos_second);
 	}
+	graph->edges_amount++;
 
 	return 0;
 }
 
+/**
+ * @brief Stable counting sort of pairs by one of their members
+ *
+ * @details Sorts (key[i], other[i]) into (sorted_key, sorted_other), keys
+ *          being vertex positions below n.
+ */
+void graph_sort_pairs(const int* key, const int* other, int* sorted_key, int* sorted_other, int amount, int n) {
+	int	*count = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+
+	for ( int i = 0; i < amount; i++ ) count[key[i] + 1]++;
+	for ( int v = 0; v < n; v++ ) count[v + 1] += count[v];
+	for ( int i = 0; i < amount; i++ ) {
+		int	position = count[key[i]]++;
+
+		sorted_key[position] = key[i];
+		sorted_other[position] = other[i];
+	}
+
+	mem_free(count);
+}
+
+/**
+ * @brief Inserts many edges at once, given by vertex positions
+ *
+ * @param graph Graph with all its vertices and no edges yet
+ * @param sources Position of the source of each edge
+ * @param destinations Position of the destination of each edge
+ * @param amount Number of edges
+ *
+ * @details The pairs are radix sorted, destination first and then source,
+ *          with one counting sort each, so equal pairs end up next to each
+ *          other and every list of neighbours comes out sorted. A linear pass
+ *          then drops duplicates and self-loops and fills the lists directly,
+ *          instead of the two lookups and the scan of the list that
+ *          graph_add_edge does for every edge. A non-directed edge is inserted
+ *          in both directions, as graph_add_edge does.
+ *
+ * @returns Number of edges dropped as duplicates or self-loops, -1 (ERROR)
+ */
+int graph_add_edges(Graph* graph, const int* sources, const int* destinations, int amount) {
+	int	n = graph->vertices_amount,
+		pairs = graph->flag == NON_DIRECTED ? 2 * amount : amount,
+		duplicates = 0,
+		loops = 0,
+		kept = 0;
+	int	*first = NULL,
+		*second = NULL,
+		*by_destination = NULL,
+		*by_destination_source = NULL;
+
+	if ( graph->edges_amount > 0 ) {
+		printf("ERROR: Edges can only be added at once to a graph without edges\n");
+		return -1;
+	}
+
+	for ( int i = 0; i < amount; i++ ) {
+		if ( sources[i] < 0 || sources[i] >= n || destinations[i] < 0 || destinations[i] >= n ) {
+			printf("ERROR: Edge %d (%d - %d) has a vertex out of your graph.\n", i, sources[i], destinations[i]);
+			return -1;
+		}
+	}
+
+	lazy_closure_destroy(graph->closure_lazy);
+	graph->closure_lazy = NULL;
+
+	first = (int*) mem_malloc( sizeof(int) * pairs + 1, MEM_SCRATCH );
+	second = (int*) mem_malloc( sizeof(int) * pairs + 1, MEM_SCRATCH );
+	by_destination = (int*) mem_malloc( sizeof(int) * pairs + 1, MEM_SCRATCH );
+	by_destination_source = (int*) mem_malloc( sizeof(int) * pairs + 1, MEM_SCRATCH );
+
+	for ( int i = 0; i < amount; i++ ) {
+		first[i] = sources[i];
+		second[i] = destinations[i];
+		if ( graph->flag == NON_DIRECTED ) {
+			first[amount + i] = destinations[i];
+			second[amount + i] = sources[i];
+		}
+	}
+
+	graph_sort_pairs(second, first, by_destination, by_destination_source, pairs, n);
+	graph_sort_pairs(by_destination_source, by_destination, first, second, pairs, n);
+
+	for ( int i = 0; i < pairs; i++ ) {
+		int	u = first[i],
+			v = second[i],
+			position = graph->edges_neighbours[u];
+
+		if ( u == v ) {
+			loops++;
+			continue;
+		}
+		if ( i > 0 && first[i - 1] == u && second[i - 1] == v ) {
+			duplicates++;
+			continue;
+		}
+
+		graph->edges[u][position] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_GRAPH );
+		strcpy( graph->edges[u][position], graph->vertices[v] );
+		graph->edges_index[u][position] = v;
+		graph->edges_neighbours[u] += 1;
+		kept++;
+	}
+
+	// Both directions of a non-directed edge were counted
+	if ( graph->flag == NON_DIRECTED ) {
+		kept /= 2;
+		duplicates /= 2;
+		loops /= 2;
+	}
+	graph->edges_amount = kept;
+
+	if ( duplicates > 0 || loops > 0 ) {
+		printf("WARNING: %d duplicate edges and %d self-loops were dropped\n", duplicates, loops);
+	}
+
+	mem_free(first);
+	mem_free(second);
+	mem_free(by_destination);
+	mem_free(by_destination_source);
+	return duplicates + loops;
+}
+
 
 /**
  * @brief Returns, if existing, the position of given vertice
@@ -203,25 +374,14 @@ int graph_add_edge(Graph* graph, const char* first_vertice, const char* second_v
  * @param graph Graph to be iterated
  * @param vertice Vertice to be found
  *
- * @details Iterate through graph vertices list until END OF MATRIX or vertice found.
+ * @details Looks the name up in the vertices table, in constant time on average.
  *
  * @returns IF END OF MATRIX, return -1 (Vertice not found)
  * 	    OTHERWISE, return index of give vertice
  */
 
 int graph_vertice_finder(Graph* graph, const char* vertice) {
-	int	position = -1,
-		i 	 =  0;
-
-
-	for ( ; i < graph->vertices_amount ; i++ ) {
-		if( strcmp(graph->vertices[i], vertice) == 0 ) {
-			position = i;
-			return position;
-		}
-	}
-
-	return position;
+	return graph->vertices_table[graph_vertice_slot(graph, vertice)];
 }
 
 /**
@@ -231,7 +391,8 @@ int graph_vertice_finder(Graph* graph, const char* vertice) {
  * @param vertice_position Position of the vertice's Neighbours list
  * @param to_be_found Vertice to be found as neighbour
  *
- * @details Iterate through vertice_position Edge list until END OF LIST or to_be_found found.
+ * @details Looks to_be_found up in the vertices table, then its position in
+ *          the sorted list of neighbours, see graph_has_edge.
  * 
  * @returns IF END OF LIST, return -1 (Neighbour not found)
  * 	    OTHERWISE, return index of given vertice
@@ -239,19 +400,115 @@ int graph_vertice_finder(Graph* graph, const char* vertice) {
  */
 
 int graph_edge_finder(Graph* graph, int vertice_position, const char* to_be_found){
-	int	position    = -1,
-		i 	   	 	=  0,
-		neighbours_amount = graph->edges_neighbours[vertice_position];
+	int	position = graph_vertice_finder(graph, to_be_found);
+
+	if ( position == -1 ) return -1;
 
+	return graph_has_edge(graph, vertice_position, position);
+}
 
-	for( ; i < neighbours_amount; i++ ){
-		if( strcmp(graph->edges[vertice_position][i], to_be_found ) == 0 ) {
-			position = i;
-			return position;
+/**
+ * @brief Orders the vertices so that every vertex comes after all its descendants
+ *
+ * @param graph Acyclic graph to be iterated
+ *
+ * @details Post-order of an iterative depth-first search, so on an acyclic
+ *          graph the closure of every neighbour of a vertex is known before
+ *          the vertex itself is reached.
+ *
+ * @returns Array with the vertex at each position, to be freed by the caller
+ */
+int* graph_descendants_first(Graph* graph) {
+	int	n = graph->vertices_amount,
+		amount = 0,
+		top = -1;
+	int	*order = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*stack = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*cursor = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH ),
+		*visited = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+
+	for ( int s = 0; s < n; s++ ) {
+		if ( visited[s] ) continue;
+
+		visited[s] = 1;
+		stack[++top] = s;
+		while ( top >= 0 ) {
+			int	v = stack[top];
+
+			if ( cursor[v] < graph->edges_neighbours[v] ) {
+				int	w = graph->edges_index[v][cursor[v]++];
+
+				if ( ! visited[w] ) {
+					visited[w] = 1;
+					stack[++top] = w;
+				}
+			} else {
+				order[amount++] = v;
+				top--;
+			}
 		}
 	}
 
-	return position;
+	mem_free(stack);
+	mem_free(cursor);
+	mem_free(visited);
+	return order;
+}
+
+/**
+ * @brief Returns the density of the graph
+ *
+ * @param graph Graph to be iterated
+ *
+ * @details Ratio between the stored neighbours and the V * (V - 1) possible
+ *          ones, an undirected edge counting once in each direction.
+ *
+ * @returns Density between 0 and 1
+ */
+double graph_density(Graph* graph) {
+	long	neighbours = 0;
+
+	if ( graph->vertices_amount < 2 ) return 0;
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		neighbours += graph->edges_neighbours[i];
+	}
+
+	return (double) neighbours / ( (double) graph->vertices_amount * ( graph->vertices_amount - 1 ) );
+}
+
+/**
+ * @brief Returns, if existing, the position of an edge given by vertex positions
+ *
+ * @param graph Graph to be iterated
+ * @param source Position of the source vertice
+ * @param destination Position of the destination vertice
+ *
+ * @details Bisection of source's Edge list, which is kept sorted by position
+ *          (see graph_insert_neighbour and graph_add_edges), so the lookup
+ *          takes O(log d) for a vertex of degree d.
+ *
+ * @returns IF END OF LIST, return -1 (Neighbour not found)
+ * 	    OTHERWISE, return index of destination in source's Edge list
+ */
+int graph_has_edge(Graph* graph, int source, int destination) {
+	int	*neighbours = graph->edges_index[source],
+		low = 0,
+		high = graph->edges_neighbours[source] - 1;
+
+	while ( low <= high ) {
+		int	middle = low + ( high - low ) / 2;
+
+		if ( neighbours[middle] == destination ) return middle;
+
+		if ( neighbours[middle] < destination ) {
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+
+	return -1;
 }
 
 /**
@@ -259,57 +516,90 @@ int graph_edge_finder(Graph* graph, int vertice_position, const char* to_be_foun
  *
  * @param graph Graph to be iterated
  *
- * @details Using depth-first search with a stack for traversal, the direct transitive 
- *          closure of all vertices of the graph is formed.
+ * @details Using depth-first search with a stack of vertex positions, which
+ *          holds each vertex at most once, the direct transitive 
+ *          closure of all vertices of the graph is formed. Graphs with density of at
+ *          least CLOSURE_DENSE_THRESHOLD are handed to the Boolean matrix engine
+ *          (bitmatrix_transitive_closure) instead, and graphs whose closure_storage
+ *          is CLOSURE_COMPRESSED to roaring_transitive_closure. A closure
+ *          constructed before is freed first.
  */
 void direct_transitive_closure(Graph* graph) {
-	Stack *s = initStack(graph->vertices_allocated);
-
-	// Helper structure to know if the vertex was already inserted in the stack during traversal
-	// 0 for not entered, 1 if already entered
-	int *vertex_visited = (int*) calloc( graph->vertices_allocated, sizeof(int) );
-	int pos = 0;
-	int pos_neighboring_vertex = -1;
-	int pos_current_vertex = -1;
-	STRING vertice = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-
-	for(int i = 0; i < graph->vertices_allocated; i++) {
-		push(s, graph->vertices[i]);
-		vertex_visited[i] = 1; 
-	
-		while ( ! isEmpty(s)) {
-			// Remove top vertex from stack
-			strcpy(vertice, "");
-			strcpy(vertice, pop(s));
-			pos_current_vertex = graph_vertice_finder(graph, vertice);
-			
-			if (pos_current_vertex != -1) {
-				// Loop through all neighbors of vertex popped from stack
-				for (int k = 0; k < graph->edges_neighbours[pos_current_vertex]; k++) {
-					pos_neighboring_vertex = graph_vertice_finder(graph, graph->edges[pos_current_vertex][k]);
-					
-					// If neighboring vertex has already been pushed onto the stack
-					if (pos_neighboring_vertex != -1 && vertex_visited[pos_neighboring_vertex] == 0) {
-						// Add unvisited neighbor vertex in stack and direct transitive closure
-						push(s, graph->edges[pos_current_vertex][k]);
-						graph->transitive_closure[i][pos] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-						strcpy(graph->transitive_closure[i][pos], "");
-						strcpy( graph->transitive_closure[i][pos], s->stack[s->top] );
-						vertex_visited[pos_neighboring_vertex] = 1; 
-						graph->num_transitive_closure[i] += 1;
-						pos++;
-					}
+	free_direct_transitive_closure(graph);
+
+	if ( graph->closure_storage == CLOSURE_COMPRESSED ) {
+		roaring_transitive_closure(graph);
+		return;
+	}
+
+	// Dense graphs are cheaper as a Boolean matrix power than as one search per vertex
+	if ( graph_density(graph) >= CLOSURE_DENSE_THRESHOLD ) {
+		bitmatrix_transitive_closure(graph);
+		return;
+	}
+
+	int	n = graph->vertices_amount,
+		top = -1;
+	int	*stack = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*visited = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+
+	graph->closure_rows = bitmatrix_initializer(graph->vertices_allocated);
+
+	for ( int i = 0; i < n; i++ ) {
+		// Visited marks hold the source + 1, so they never need clearing
+		visited[i] = i + 1;
+		stack[++top] = i;
+
+		while ( top >= 0 ) {
+			int	v = stack[top--];
+
+			// Unvisited neighbours are pushed and added to the closure, in the order of the edges
+			for ( int k = 0; k < graph->edges_neighbours[v]; k++ ) {
+				int	w = graph->edges_index[v][k];
+
+				if ( visited[w] != i + 1 ) {
+					visited[w] = i + 1;
+					stack[++top] = w;
+					graph->transitive_closure[i][graph->num_transitive_closure[i]] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_CLOSURE );
+					strcpy( graph->transitive_closure[i][graph->num_transitive_closure[i]], graph->vertices[w] );
+					graph->num_transitive_closure[i] += 1;
+					bitmatrix_set(graph->closure_rows, i, w);
 				}
 			}
 		}
+	}
 
-		// Update visited vertices to the transitive closure of the next vertex
-		for (int j = 0; j < graph->vertices_allocated; j++) {
-			vertex_visited[j] = 0;
-		}
-		pos = 0;
+	mem_free(stack);
+	mem_free(visited);
+}
+
+/**
+ * @brief Checks if a vertex is in the direct transitive closure of another
+ *
+ * @param graph Graph whose closure was constructed
+ * @param source Position of the vertex whose closure is searched
+ * @param destination Position of the vertex to be found
+ *
+ * @details Answers from whichever storage holds the closure. Without any,
+ *          the rows asked for are computed on demand by a LazyClosure, which
+ *          keeps the most recently used ones up to LAZY_CLOSURE_DEFAULT_BYTES.
+ *
+ * @returns 1 if destination is reachable from source, otherwise 0
+ */
+int graph_closure_contains(Graph* graph, int source, int destination) {
+	if ( graph->closure_compressed != NULL ) {
+		return roaring_contains(graph->closure_compressed[source], destination);
 	}
-}	
+
+	if ( graph->closure_rows != NULL ) {
+		return bitmatrix_test(graph->closure_rows, source, destination);
+	}
+
+	// No closure was constructed, the rows asked for are computed and cached
+	if ( graph->closure_lazy == NULL ) graph->closure_lazy = lazy_closure_initializer(graph, LAZY_CLOSURE_DEFAULT_BYTES);
+
+	return lazy_closure_contains(graph->closure_lazy, source, destination);
+}
 
 /**
  * @brief Deletes a neighboring vertex, which represents an edge in the graph
@@ -323,16 +613,20 @@ void direct_transitive_closure(Graph* graph) {
  */
 void free_edge(Graph* graph, int pos_vertice, int pos_vertice_delete) {
 	int number_neighbours = graph->edges_neighbours[pos_vertice];
+
+	lazy_closure_destroy(graph->closure_lazy);
+	graph->closure_lazy = NULL;
 	//printf("linha edges: %d  - posVerticeEliminado: %d  - numberVizinhos: %d\n", pos_vertice, pos_vertice_delete, number_neighbours);
 
 	for (int i = pos_vertice_delete; i < number_neighbours; i++) {
 		strcpy(graph->edges[pos_vertice][i], "");
 		if (i < (number_neighbours - 1)) {
 			strcpy(graph->edges[pos_vertice][i], graph->edges[pos_vertice][i + 1]);
+			graph->edges_index[pos_vertice][i] = graph->edges_index[pos_vertice][i + 1];
 		}
 	}
 	if (graph->edges[pos_vertice][number_neighbours -1] != NULL) {
-		free(graph->edges[pos_vertice][number_neighbours -1]);
+		mem_free(graph->edges[pos_vertice][number_neighbours -1]);
 	}
     graph->edges_neighbours[pos_vertice] -= 1;
 }
@@ -371,6 +665,7 @@ void graph_print_edges(Graph* graph){
 void graph_print_direct_transitive_closure(Graph* graph) {
 	int	i = 0,
 		j = 0; 
+	int	*values = (int*) mem_malloc( sizeof(int) * graph->vertices_amount + 1, MEM_SCRATCH );
 
 	printf("\nDirect transitive closure of your graph: \n");	
 
@@ -379,6 +674,13 @@ void graph_print_direct_transitive_closure(Graph* graph) {
 		printf("%s's direct transitive closure: \n\t", graph->vertices[i]);
 		int	num_vertices_transitive_closure = graph->num_transitive_closure[i];
 		if ( num_vertices_transitive_closure == 0 ) { printf("EMPTY\n"); }
+		else if ( graph->closure_compressed != NULL ) {
+			// Compressed rows keep no names, they are listed in vertex order
+			roaring_to_array(graph->closure_compressed[i], values);
+			for( j = 0; j < num_vertices_transitive_closure; j++ ){
+				printf("%s-\t", graph->vertices[values[j]]);
+			}
+		}
 		else {
 			for( j = 0; j < num_vertices_transitive_closure; j++ ){
 				printf("%s-\t", graph->transitive_closure[i][j]);
@@ -386,6 +688,8 @@ void graph_print_direct_transitive_closure(Graph* graph) {
 		}
 		printf("\n");
 	}
+
+	mem_free(values);
 }
 
 /**
@@ -399,18 +703,52 @@ void free_direct_transitive_closure(Graph* graph) {
 		j = 0; 
 
 	for( ; i < graph->vertices_amount ; i++ ){ 
-		for( j = 0; j < graph->num_transitive_closure[i]; j++ )	{
-			free(graph->transitive_closure[i][j]);
+		// Compressed rows have no names to free
+		for( j = 0; graph->closure_compressed == NULL && j < graph->num_transitive_closure[i]; j++ )	{
+			mem_free(graph->transitive_closure[i][j]);
 		}
 		graph->num_transitive_closure[i] = 0;
 	}
+
+	bitmatrix_destroy(graph->closure_rows);
+	graph->closure_rows = NULL;
+
+	lazy_closure_destroy(graph->closure_lazy);
+	graph->closure_lazy = NULL;
+
+	if ( graph->closure_compressed != NULL ) {
+		for ( i = 0; i < graph->vertices_amount; i++ ) {
+			roaring_destroy(graph->closure_compressed[i]);
+		}
+		mem_free(graph->closure_compressed);
+		graph->closure_compressed = NULL;
+	}
 }
 
+/**
+ * @brief Frees a graph with its vertices, edges and closure
+ */
 void graph_destroy(Graph* graph) {
-	//ver se pode usar a função free 
-	free(graph->vertices);
-	free(graph->edges);
-	free(graph);
+	free_direct_transitive_closure(graph);
+
+	for ( int i = 0; i < graph->vertices_amount; i++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[i]; k++ ) {
+			mem_free(graph->edges[i][k]);
+		}
+		mem_free(graph->edges[i]);
+		mem_free(graph->edges_index[i]);
+		mem_free(graph->transitive_closure[i]);
+		mem_free(graph->vertices[i]);
+	}
+
+	mem_free(graph->vertices);
+	mem_free(graph->edges);
+	mem_free(graph->edges_index);
+	mem_free(graph->edges_neighbours);
+	mem_free(graph->transitive_closure);
+	mem_free(graph->num_transitive_closure);
+	mem_free(graph->vertices_table);
+	mem_free(graph);
 }
 
 /**
@@ -419,17 +757,18 @@ void graph_destroy(Graph* graph) {
  * @return 1 if a cycle is found, 0 otherwise
  */
 int isCyclic(Graph* graph) {
-    int* visited = (int*) calloc(graph->vertices_amount, sizeof(int));
-    int* stack = (int*) calloc(graph->vertices_amount, sizeof(int));
+    int* visited = (int*) mem_calloc(graph->vertices_amount, sizeof(int), MEM_SCRATCH);
+    int* stack = (int*) mem_calloc(graph->vertices_amount, sizeof(int), MEM_SCRATCH);
 
-    for (int i = 0; i < graph->vertices_amount; i++) {
-        if (isCyclicUntil(graph, i, visited, stack))
-            return 1;
+    int cyclic = 0;
+
+    for (int i = 0; i < graph->vertices_amount && ! cyclic; i++) {
+        cyclic = isCyclicUntil(graph, i, visited, stack);
     }
 
-    free(visited);
-    free(stack);
-    return 0;
+    mem_free(visited);
+    mem_free(stack);
+    return cyclic;
 }
 
 /**
@@ -20,6 +20,9 @@
 	#define MAX_AMOUNT		1000		/* Max number amount of vertices AND edges */
 	#define NON_DIRECTED 		0		/* Graph not directed */
 	#define DIRECTED		1		/* Graph directed */
+	#define CLOSURE_DENSE		0		/* Closure rows stored as plain bits */
+	#define CLOSURE_COMPRESSED	1		/* Closure rows stored as compressed bitmaps */
+	#define CLOSURE_LAZY		2		/* No closure constructed up front, rows computed on demand by graph_closure_contains */
 	/**@}*/
 
 	typedef struct Graph {
@@ -38,8 +41,14 @@
 		STRING*	 vertices;				/* Vertices values */
 		int	 vertices_amount;			/* Number of vertices in Graph at the moment */
 		int	 vertices_allocated;			/* Number of allocated vertices at the initialization time */		
-		STRING** transitive_closure;			/* Direct transitive closure of all vertices of the graph */
+		int*	 vertices_table;			/* Position of each vertex in an open-addressing table keyed by name, -1 if free */
+		int	 vertices_table_size;			/* Slots in vertices_table, a power of two */
+		STRING** transitive_closure;			/* Direct transitive closure of all vertices of the graph, left empty with closure_compressed */
 		int*	 num_transitive_closure;		/* Number of vertices in transitive closure */
+		struct BitMatrix* closure_rows;			/* Same closure as bit rows, row i column j set if j is reachable from i */
+		struct Roaring** closure_compressed;		/* Same closure as compressed bitmaps, when closure_storage is CLOSURE_COMPRESSED */
+		int	 closure_storage;			/* CLOSURE_DENSE, CLOSURE_COMPRESSED or CLOSURE_LAZY */
+		struct LazyClosure* closure_lazy;		/* Rows computed on demand while no closure is constructed, see lazy_closure.h */
 		/**@}*/
 			
 
@@ -51,6 +60,7 @@
 		int	 edges_amount;		/* Number of edges in Graph at the moment */
 		int	 edges_allocated;	/* Number of allocated edges at the initialization time */
 		int*	 edges_neighbours;	/* Number of each vertice's neighbours */
+		int**	 edges_index;		/* Position in Vertices Array of each neighbour, parallel to edges and sorted */
 		/**@}*/
 
 	} Graph;
@@ -68,11 +78,17 @@
 extern Graph* graph_initializer(int number_of_vertices, int number_of_edges, int flag);
 extern Graph* graph_clone(Graph* graph);
 extern int  graph_add_vertice(Graph* graph, STRING vertice);
+extern void graph_insert_neighbour(Graph* graph, int vertice, int neighbour);
 extern int  graph_add_edge(Graph* graph, const char* source, const char* destination);
+extern int  graph_add_edges(Graph* graph, const int* sources, const int* destinations, int amount);
 extern void graph_destroy(Graph* graph);
 extern int  graph_vertice_finder(Graph* graph, const char* vertice);
 extern int  graph_edge_finder(Graph* graph, int vertice_position, const char* to_be_found);
+extern int  graph_has_edge(Graph* graph, int source, int destination);
+extern double graph_density(Graph* graph);
+extern int* graph_descendants_first(Graph* graph);
 extern void direct_transitive_closure(Graph* graph);
+extern int  graph_closure_contains(Graph* graph, int source, int destination);
 extern void free_edge(Graph* graph, int pos_vertice, int pos_vertice_delete);
 extern void graph_print_direct_transitive_closure(Graph* graph);
 extern void  free_direct_transitive_closure(Graph* graph);
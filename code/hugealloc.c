@@ -0,0 +1,170 @@
+#include "hugealloc.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define HUGE_MPOL_INTERLEAVE	3		/* MPOL_INTERLEAVE of <numaif.h>, not always installed */
+#define HUGE_MAX_NODES		1024		/* Nodes a mask can name */
+#define HUGE_NODES_ONLINE	"/sys/devices/system/node/online"
+
+int huge_pages = 1;
+int huge_interleave = 0;
+
+static int huge_interleave_failed = 0;
+
+/**
+ * @brief Header of a block, the last bytes before it
+ */
+typedef struct HugeBlock {
+	void*	start;		/* Start of the mapping, or of the tracked block */
+	size_t	mapped;		/* Bytes mapped, 0 for a tracked block */
+	size_t	size;		/* Bytes asked for */
+	int	kind;		/* HUGE_MAPPED or HUGE_TRACKED */
+	int	tag;		/* Tag the bytes are accounted to */
+} HugeBlock;
+
+/**
+ * @brief Mask of the online NUMA nodes
+ *
+ * @details Reads ranges such as "0-3,6" from HUGE_NODES_ONLINE.
+ *
+ * @returns Number of nodes in mask, 0 if it could not be read
+ */
+int huge_nodes(unsigned long* mask) {
+	FILE	*file = fopen(HUGE_NODES_ONLINE, "r");
+	int	first = 0,
+		last = 0,
+		nodes = 0;
+	char	separator = 0;
+
+	memset(mask, 0, HUGE_MAX_NODES / 8);
+	if ( file == NULL ) return 0;
+
+	while ( fscanf(file, "%d", &first) == 1 ) {
+		last = first;
+		separator = (char) fgetc(file);
+		if ( separator == '-' ) {
+			if ( fscanf(file, "%d", &last) != 1 ) break;
+			separator = (char) fgetc(file);
+		}
+
+		for ( int node = first; node <= last && node < HUGE_MAX_NODES; node++ ) {
+			mask[node / ( 8 * sizeof(unsigned long) )] |= 1UL << ( node % ( 8 * sizeof(unsigned long) ) );
+			nodes++;
+		}
+		if ( separator != ',' ) break;
+	}
+
+	fclose(file);
+	return nodes;
+}
+
+/**
+ * @brief Spreads the pages of a mapping over every NUMA node
+ *
+ * @details Through the mbind system call, so libnuma is not needed. Kernels
+ *          or machines without NUMA are warned about once, the pages then
+ *          stay where the kernel puts them.
+ */
+void huge_spread(void* start, size_t length) {
+	unsigned long	mask[HUGE_MAX_NODES / ( 8 * sizeof(unsigned long) )];
+	int		nodes = huge_nodes(mask);
+
+	if ( nodes < 2 || huge_interleave_failed ) return;
+
+#ifdef SYS_mbind
+	if ( syscall(SYS_mbind, start, length, HUGE_MPOL_INTERLEAVE, mask, (unsigned long) HUGE_MAX_NODES, 0) == 0 ) return;
+#endif
+
+	printf("WARNING: Pages could not be interleaved over the %d NUMA nodes\n", nodes);
+	huge_interleave_failed = 1;
+}
+
+/**
+ * @brief Allocates amount zeroed elements of size bytes, on huge pages when large
+ *
+ * @param amount Number of elements
+ * @param size Bytes of an element
+ * @param tag Tag the bytes are accounted to, see memtrack.h
+ *
+ * @details Blocks of at least HUGE_MIN_SIZE bytes are mapped anonymously,
+ *          aligned on HUGE_PAGE_SIZE, and the kernel is asked to back them
+ *          with transparent huge pages, so random rows of a closure cost far
+ *          fewer TLB misses. With huge_interleave their pages are also spread
+ *          over the NUMA nodes. Anonymous pages are zero, so nothing is
+ *          written until used. Anything that fails, or a smaller block, falls
+ *          back to mem_calloc; both kinds are freed by huge_free and accounted
+ *          like any tracked block. A huge page is only used for a whole
+ *          HUGE_PAGE_SIZE extent, so smaller blocks gain nothing from it; the
+ *          closure of a graph below MAX_AMOUNT vertices is about 128 KB, and
+ *          only larger graphs, or bench/huge_bench.c, take this path.
+ *
+ * @returns Reference to the block, aligned on HUGE_HEADER bytes, NULL on ERROR
+ */
+void* huge_calloc(size_t amount, size_t size, int tag) {
+	size_t		bytes = amount * size,
+			mapped = ( HUGE_HEADER + bytes + HUGE_PAGE_SIZE - 1 ) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	char		*start = MAP_FAILED,
+			*aligned = NULL;
+	HugeBlock	*block = NULL;
+
+	if ( huge_pages && bytes >= HUGE_MIN_SIZE ) {
+		// One more page than needed, so an aligned start can be cut out of it
+		start = (char*) mmap(NULL, mapped + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	}
+
+	if ( start == MAP_FAILED ) {
+		// mem_calloc only aligns on 16 bytes, one more header leaves room to align on HUGE_HEADER
+		start = (char*) mem_calloc( 1, 2 * HUGE_HEADER + bytes, tag );
+		if ( start == NULL ) return NULL;
+
+		aligned = (char*) ( ( (size_t) start + 2 * HUGE_HEADER - 1 ) / HUGE_HEADER * HUGE_HEADER );
+		block = (HugeBlock*) aligned - 1;
+		block->start = start;
+		block->mapped = 0;
+		block->size = bytes;
+		block->kind = HUGE_TRACKED;
+		block->tag = tag;
+		return aligned;
+	}
+
+	aligned = (char*) ( ( (size_t) start + HUGE_PAGE_SIZE - 1 ) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE );
+	if ( aligned > start ) munmap(start, aligned - start);
+	if ( aligned + mapped < start + mapped + HUGE_PAGE_SIZE ) munmap(aligned + mapped, start + HUGE_PAGE_SIZE - aligned);
+
+#ifdef MADV_HUGEPAGE
+	madvise(aligned, mapped, MADV_HUGEPAGE);
+#endif
+	if ( huge_interleave ) huge_spread(aligned, mapped);
+
+	block = (HugeBlock*) ( aligned + HUGE_HEADER ) - 1;
+	block->start = aligned;
+	block->mapped = mapped;
+	block->size = bytes;
+	block->kind = HUGE_MAPPED;
+	block->tag = tag;
+	mem_account((long) bytes, tag);
+	return aligned + HUGE_HEADER;
+}
+
+/**
+ * @brief Frees a block of huge_calloc, NULL is ignored
+ */
+void huge_free(void* pointer) {
+	HugeBlock	*block = NULL;
+
+	if ( pointer == NULL ) return;
+
+	block = (HugeBlock*) pointer - 1;
+	if ( block->kind == HUGE_TRACKED ) {
+		mem_free(block->start);
+		return;
+	}
+
+	mem_account(-(long) block->size, block->tag);
+	munmap(block->start, block->mapped);
+}
@@ -0,0 +1,41 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/hugealloc.h
+ *
+ * @brief Definitions of the allocation of large arrays on huge pages
+ *
+ */
+#ifndef HUGEALLOC_H_
+#define HUGEALLOC_H_
+
+	#include <stddef.h>
+
+	/**
+	 * @name Huge allocation definitions
+	 */
+	/**@{*/
+	#define HUGE_PAGE_SIZE		( 2L << 20 )	/* Size and alignment of a transparent huge page */
+	#define HUGE_MIN_SIZE		HUGE_PAGE_SIZE	/* Blocks below this are left to mem_calloc */
+	#define HUGE_HEADER		64		/* Bytes before every block, which stays aligned on a cache line */
+	#define HUGE_MAPPED		1		/* Block mapped by huge_calloc */
+	#define HUGE_TRACKED		2		/* Block allocated by mem_calloc */
+	/**@}*/
+
+	extern int huge_pages;		/* 1 to map large blocks on huge pages (default), 0 to leave them to mem_calloc */
+	extern int huge_interleave;	/* 1 to spread the pages of large blocks over every NUMA node */
+
+#endif /* HUGEALLOC_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Huge allocation operations
+ */
+/**@{*/
+extern void* huge_calloc(size_t amount, size_t size, int tag);
+extern void  huge_free(void* pointer);
+/**@}*/
@@ -0,0 +1,290 @@
+#include "graph.h"
+#include "bitset.h"
+#include "kernels.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+	#include <immintrin.h>
+	#define KERNELS_X86
+#endif
+
+  /***** ============== ****/
+ /***** SCALAR KERNELS *****/
+/***** ============== ****/
+
+static void scalar_row_union(WORD* destination, const WORD* source, int words) {
+	for ( int i = 0; i < words; i++ ) destination[i] |= source[i];
+}
+
+static void scalar_row_difference(WORD* destination, const WORD* source, int words) {
+	for ( int i = 0; i < words; i++ ) destination[i] &= ~source[i];
+}
+
+static long scalar_row_popcount(const WORD* row, int words) {
+	long	count = 0;
+
+	for ( int i = 0; i < words; i++ ) count += __builtin_popcountll(row[i]);
+	return count;
+}
+
+static int scalar_row_disjoint(const WORD* first, const WORD* second, int words) {
+	for ( int i = 0; i < words; i++ ) {
+		if ( first[i] & second[i] ) return 0;
+	}
+	return 1;
+}
+
+static int scalar_row_equal(const WORD* first, const WORD* second, int words) {
+	for ( int i = 0; i < words; i++ ) {
+		if ( first[i] != second[i] ) return 0;
+	}
+	return 1;
+}
+
+#ifdef KERNELS_X86
+
+  /***** ============ ****/
+ /***** SSE2 KERNELS *****/
+/***** ============ ****/
+
+__attribute__((target("sse2")))
+static void sse2_row_union(WORD* destination, const WORD* source, int words) {
+	int	i = 0;
+
+	for ( ; i + 2 <= words; i += 2 ) {
+		__m128i	d = _mm_loadu_si128( (const __m128i*) ( destination + i ) ),
+			s = _mm_loadu_si128( (const __m128i*) ( source + i ) );
+		_mm_storeu_si128( (__m128i*) ( destination + i ), _mm_or_si128(d, s) );
+	}
+	scalar_row_union(destination + i, source + i, words - i);
+}
+
+__attribute__((target("sse2")))
+static void sse2_row_difference(WORD* destination, const WORD* source, int words) {
+	int	i = 0;
+
+	for ( ; i + 2 <= words; i += 2 ) {
+		__m128i	d = _mm_loadu_si128( (const __m128i*) ( destination + i ) ),
+			s = _mm_loadu_si128( (const __m128i*) ( source + i ) );
+		_mm_storeu_si128( (__m128i*) ( destination + i ), _mm_andnot_si128(s, d) );
+	}
+	scalar_row_difference(destination + i, source + i, words - i);
+}
+
+__attribute__((target("sse2")))
+static int sse2_row_disjoint(const WORD* first, const WORD* second, int words) {
+	int	i = 0;
+
+	for ( ; i + 2 <= words; i += 2 ) {
+		__m128i	both = _mm_and_si128( _mm_loadu_si128( (const __m128i*) ( first + i ) ),
+					      _mm_loadu_si128( (const __m128i*) ( second + i ) ) );
+		if ( _mm_movemask_epi8( _mm_cmpeq_epi8(both, _mm_setzero_si128()) ) != 0xFFFF ) return 0;
+	}
+	return scalar_row_disjoint(first + i, second + i, words - i);
+}
+
+__attribute__((target("sse2")))
+static int sse2_row_equal(const WORD* first, const WORD* second, int words) {
+	int	i = 0;
+
+	for ( ; i + 2 <= words; i += 2 ) {
+		__m128i	same = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*) ( first + i ) ),
+					       _mm_loadu_si128( (const __m128i*) ( second + i ) ) );
+		if ( _mm_movemask_epi8(same) != 0xFFFF ) return 0;
+	}
+	return scalar_row_equal(first + i, second + i, words - i);
+}
+
+  /***** ============ ****/
+ /***** AVX2 KERNELS *****/
+/***** ============ ****/
+
+__attribute__((target("avx2")))
+static void avx2_row_union(WORD* destination, const WORD* source, int words) {
+	int	i = 0;
+
+	for ( ; i + 4 <= words; i += 4 ) {
+		__m256i	d = _mm256_loadu_si256( (const __m256i*) ( destination + i ) ),
+			s = _mm256_loadu_si256( (const __m256i*) ( source + i ) );
+		_mm256_storeu_si256( (__m256i*) ( destination + i ), _mm256_or_si256(d, s) );
+	}
+	scalar_row_union(destination + i, source + i, words - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_row_difference(WORD* destination, const WORD* source, int words) {
+	int	i = 0;
+
+	for ( ; i + 4 <= words; i += 4 ) {
+		__m256i	d = _mm256_loadu_si256( (const __m256i*) ( destination + i ) ),
+			s = _mm256_loadu_si256( (const __m256i*) ( source + i ) );
+		_mm256_storeu_si256( (__m256i*) ( destination + i ), _mm256_andnot_si256(s, d) );
+	}
+	scalar_row_difference(destination + i, source + i, words - i);
+}
+
+__attribute__((target("avx2,popcnt")))
+static long avx2_row_popcount(const WORD* row, int words) {
+	long	count = 0;
+
+	for ( int i = 0; i < words; i++ ) count += _mm_popcnt_u64(row[i]);
+	return count;
+}
+
+__attribute__((target("avx2")))
+static int avx2_row_disjoint(const WORD* first, const WORD* second, int words) {
+	int	i = 0;
+
+	for ( ; i + 4 <= words; i += 4 ) {
+		__m256i	a = _mm256_loadu_si256( (const __m256i*) ( first + i ) ),
+			b = _mm256_loadu_si256( (const __m256i*) ( second + i ) );
+		if ( ! _mm256_testz_si256(a, b) ) return 0;
+	}
+	return scalar_row_disjoint(first + i, second + i, words - i);
+}
+
+__attribute__((target("avx2")))
+static int avx2_row_equal(const WORD* first, const WORD* second, int words) {
+	int	i = 0;
+
+	for ( ; i + 4 <= words; i += 4 ) {
+		__m256i	diff = _mm256_xor_si256( _mm256_loadu_si256( (const __m256i*) ( first + i ) ),
+						 _mm256_loadu_si256( (const __m256i*) ( second + i ) ) );
+		if ( ! _mm256_testz_si256(diff, diff) ) return 0;
+	}
+	return scalar_row_equal(first + i, second + i, words - i);
+}
+
+  /***** ============== ****/
+ /***** AVX-512 KERNELS ****/
+/***** ============== ****/
+
+__attribute__((target("avx512f")))
+static void avx512_row_union(WORD* destination, const WORD* source, int words) {
+	int	i = 0;
+
+	for ( ; i + 8 <= words; i += 8 ) {
+		__m512i	d = _mm512_loadu_si512( (const void*) ( destination + i ) ),
+			s = _mm512_loadu_si512( (const void*) ( source + i ) );
+		_mm512_storeu_si512( (void*) ( destination + i ), _mm512_or_si512(d, s) );
+	}
+	avx2_row_union(destination + i, source + i, words - i);
+}
+
+__attribute__((target("avx512f")))
+static void avx512_row_difference(WORD* destination, const WORD* source, int words) {
+	int	i = 0;
+
+	for ( ; i + 8 <= words; i += 8 ) {
+		__m512i	d = _mm512_loadu_si512( (const void*) ( destination + i ) ),
+			s = _mm512_loadu_si512( (const void*) ( source + i ) );
+		_mm512_storeu_si512( (void*) ( destination + i ), _mm512_andnot_si512(s, d) );
+	}
+	avx2_row_difference(destination + i, source + i, words - i);
+}
+
+__attribute__((target("avx512f")))
+static int avx512_row_disjoint(const WORD* first, const WORD* second, int words) {
+	int	i = 0;
+
+	for ( ; i + 8 <= words; i += 8 ) {
+		__m512i	a = _mm512_loadu_si512( (const void*) ( first + i ) ),
+			b = _mm512_loadu_si512( (const void*) ( second + i ) );
+		if ( _mm512_test_epi64_mask(a, b) ) return 0;
+	}
+	return avx2_row_disjoint(first + i, second + i, words - i);
+}
+
+__attribute__((target("avx512f")))
+static int avx512_row_equal(const WORD* first, const WORD* second, int words) {
+	int	i = 0;
+
+	for ( ; i + 8 <= words; i += 8 ) {
+		__m512i	a = _mm512_loadu_si512( (const void*) ( first + i ) ),
+			b = _mm512_loadu_si512( (const void*) ( second + i ) );
+		if ( _mm512_cmpneq_epi64_mask(a, b) ) return 0;
+	}
+	return avx2_row_equal(first + i, second + i, words - i);
+}
+
+#endif /* KERNELS_X86 */
+
+Kernels kernels = {
+	KERNELS_SCALAR, "scalar",
+	scalar_row_union, scalar_row_difference, scalar_row_popcount, scalar_row_disjoint, scalar_row_equal
+};
+
+/**
+ * @brief Returns the best kernel level supported by the running CPU
+ *
+ * @details Reads CPUID through the compiler builtins, so one binary runs the
+ *          widest registers of each host.
+ */
+int kernels_detect(void) {
+#ifdef KERNELS_X86
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx512f") ) return KERNELS_AVX512;
+	if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") ) return KERNELS_AVX2;
+	if ( __builtin_cpu_supports("sse2") ) return KERNELS_SSE2;
+#endif
+	return KERNELS_SCALAR;
+}
+
+/**
+ * @brief Selects the kernels of given level
+ *
+ * @param level One of the KERNELS_* values
+ *
+ * @details A level above what the CPU supports falls back to the best
+ *          supported one. Must not be called while kernels are in use.
+ */
+void kernels_select(int level) {
+	int	supported = kernels_detect();
+
+	if ( level > supported ) level = supported;
+
+	kernels.level = KERNELS_SCALAR;
+	kernels.name = "scalar";
+	kernels.row_union = scalar_row_union;
+	kernels.row_difference = scalar_row_difference;
+	kernels.row_popcount = scalar_row_popcount;
+	kernels.row_disjoint = scalar_row_disjoint;
+	kernels.row_equal = scalar_row_equal;
+
+#ifdef KERNELS_X86
+	if ( level == KERNELS_SSE2 ) {
+		kernels.name = "sse2";
+		kernels.row_union = sse2_row_union;
+		kernels.row_difference = sse2_row_difference;
+		kernels.row_disjoint = sse2_row_disjoint;
+		kernels.row_equal = sse2_row_equal;
+	} else if ( level == KERNELS_AVX2 ) {
+		kernels.name = "avx2";
+		kernels.row_union = avx2_row_union;
+		kernels.row_difference = avx2_row_difference;
+		kernels.row_popcount = avx2_row_popcount;
+		kernels.row_disjoint = avx2_row_disjoint;
+		kernels.row_equal = avx2_row_equal;
+	} else if ( level == KERNELS_AVX512 ) {
+		// Population count stays on popcnt, VPOPCNTDQ is missing on Skylake-X
+		kernels.name = "avx512";
+		kernels.row_union = avx512_row_union;
+		kernels.row_difference = avx512_row_difference;
+		kernels.row_popcount = avx2_row_popcount;
+		kernels.row_disjoint = avx512_row_disjoint;
+		kernels.row_equal = avx512_row_equal;
+	}
+#endif
+	kernels.level = level;
+}
+
+/**
+ * @brief Selects the widest kernels of the running CPU
+ *
+ * @details Called once at startup, before any closure is computed
+ */
+void kernels_initializer(void) {
+	kernels_select( kernels_detect() );
+}
@@ -0,0 +1,61 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/kernels.h
+ *
+ * @brief Struct of the row kernels used on bitset rows
+ *
+ */
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+	/**
+	 * @name Kernels definitions
+	 */
+	/**@{*/
+	#define KERNELS_SCALAR		0		/* Portable C, one WORD at a time */
+	#define KERNELS_SSE2		1		/* 128-bit registers */
+	#define KERNELS_AVX2		2		/* 256-bit registers */
+	#define KERNELS_AVX512		3		/* 512-bit registers */
+	/**@}*/
+
+	typedef struct Kernels {
+
+		/**
+		 * @name Selected instruction set
+		 */
+		/**@{*/
+		int		level;		/* One of the KERNELS_* values */
+		const char*	name;		/* Printable name of the level */
+		/**@}*/
+
+		/**
+		 * @name Row operations, all rows have the same number of WORDs
+		 */
+		/**@{*/
+		void	(*row_union)(WORD* destination, const WORD* source, int words);		/* destination |= source */
+		void	(*row_difference)(WORD* destination, const WORD* source, int words);	/* destination &= ~source */
+		long	(*row_popcount)(const WORD* row, int words);				/* Number of set bits */
+		int	(*row_disjoint)(const WORD* first, const WORD* second, int words);	/* 1 if first & second is empty */
+		int	(*row_equal)(const WORD* first, const WORD* second, int words);		/* 1 if both rows are equal */
+		/**@}*/
+
+	} Kernels;
+
+	extern Kernels kernels;		/* Kernels of the running host, scalar until kernels_initializer runs */
+
+#endif /* KERNELS_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Kernels operations
+ */
+/**@{*/
+extern void kernels_initializer(void);
+extern int  kernels_detect(void);
+extern void kernels_select(int level);
+/**@}*/
@@ -0,0 +1,179 @@
+#include "graph.h"
+#include "bitset.h"
+#include "kernels.h"
+#include "lazy_closure.h"
+#include "memtrack.h"
+#include "hugealloc.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Allocates an empty lazy closure of a graph
+ *
+ * @param graph Graph whose closure rows will be asked for
+ * @param bytes Memory given to cached rows, at least one row is always kept
+ *
+ * @returns Reference to newly create LazyClosure
+ */
+LazyClosure* lazy_closure_initializer(Graph* graph, long bytes) {
+	LazyClosure	*lazy = (LazyClosure*) mem_malloc( sizeof(LazyClosure), MEM_CLOSURE );
+	int		n = graph->vertices_amount;
+
+	lazy->graph = graph;
+	lazy->words = ( n + WORD_BITS - 1 ) / WORD_BITS;
+	lazy->capacity = (int) ( bytes / ( (long) sizeof(WORD) * ( lazy->words > 0 ? lazy->words : 1 ) ) );
+	if ( lazy->capacity > n ) lazy->capacity = n;
+	if ( lazy->capacity < 1 ) lazy->capacity = 1;
+
+	lazy->rows = (WORD*) huge_calloc( (long) lazy->capacity * lazy->words + 1, sizeof(WORD), MEM_CLOSURE );
+	lazy->used = 0;
+	lazy->slot = (int*) mem_malloc( sizeof(int) * n + 1, MEM_CLOSURE );
+	lazy->owner = (int*) mem_malloc( sizeof(int) * lazy->capacity, MEM_CLOSURE );
+	lazy->newer = (int*) mem_malloc( sizeof(int) * lazy->capacity, MEM_CLOSURE );
+	lazy->older = (int*) mem_malloc( sizeof(int) * lazy->capacity, MEM_CLOSURE );
+	lazy->newest = LAZY_CLOSURE_NONE;
+	lazy->oldest = LAZY_CLOSURE_NONE;
+
+	lazy->stack = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+	lazy->visited = (WORD*) mem_malloc( sizeof(WORD) * lazy->words + 1, MEM_SCRATCH );
+	lazy->hits = 0;
+	lazy->misses = 0;
+	lazy->evictions = 0;
+
+	for ( int v = 0; v < n; v++ ) lazy->slot[v] = LAZY_CLOSURE_NONE;
+
+	return lazy;
+}
+
+/**
+ * @brief Frees a lazy closure and its cached rows
+ */
+void lazy_closure_destroy(LazyClosure* lazy) {
+	if ( lazy == NULL ) return;
+
+	huge_free(lazy->rows);
+	mem_free(lazy->slot);
+	mem_free(lazy->owner);
+	mem_free(lazy->newer);
+	mem_free(lazy->older);
+	mem_free(lazy->stack);
+	mem_free(lazy->visited);
+	mem_free(lazy);
+}
+
+/**
+ * @brief Takes a slot out of the recency list
+ */
+void lazy_closure_unlink(LazyClosure* lazy, int slot) {
+	if ( lazy->newer[slot] != LAZY_CLOSURE_NONE ) {
+		lazy->older[lazy->newer[slot]] = lazy->older[slot];
+	} else {
+		lazy->newest = lazy->older[slot];
+	}
+
+	if ( lazy->older[slot] != LAZY_CLOSURE_NONE ) {
+		lazy->newer[lazy->older[slot]] = lazy->newer[slot];
+	} else {
+		lazy->oldest = lazy->newer[slot];
+	}
+}
+
+/**
+ * @brief Puts a slot at the front of the recency list
+ */
+void lazy_closure_link(LazyClosure* lazy, int slot) {
+	lazy->newer[slot] = LAZY_CLOSURE_NONE;
+	lazy->older[slot] = lazy->newest;
+	if ( lazy->newest != LAZY_CLOSURE_NONE ) lazy->newer[lazy->newest] = slot;
+	lazy->newest = slot;
+	if ( lazy->oldest == LAZY_CLOSURE_NONE ) lazy->oldest = slot;
+}
+
+/**
+ * @brief Returns the closure row of a vertex, computing it if it is not cached
+ *
+ * @param lazy Lazy closure to be asked
+ * @param vertex Position of the vertex
+ *
+ * @details A missing row takes the slot of the least recently used one and is
+ *          filled by a depth-first search from the vertex. A vertex met on the
+ *          way whose row is cached is not expanded: its row is merged instead,
+ *          and everything in it marked as reached. As in
+ *          direct_transitive_closure, a vertex is not part of its own row.
+ *
+ * @returns Row of vertex, valid until the next call on lazy
+ */
+const WORD* lazy_closure_row(LazyClosure* lazy, int vertex) {
+	Graph	*graph = lazy->graph;
+	WORD	*row = NULL;
+	int	slot = lazy->slot[vertex],
+		top = -1;
+
+	if ( slot != LAZY_CLOSURE_NONE ) {
+		lazy->hits++;
+		lazy_closure_unlink(lazy, slot);
+		lazy_closure_link(lazy, slot);
+		return lazy->rows + (long) slot * lazy->words;
+	}
+
+	lazy->misses++;
+	if ( lazy->used < lazy->capacity ) {
+		slot = lazy->used++;
+	} else {
+		// The evicted row is no longer there to be merged by the search below
+		slot = lazy->oldest;
+		lazy_closure_unlink(lazy, slot);
+		lazy->slot[lazy->owner[slot]] = LAZY_CLOSURE_NONE;
+		lazy->evictions++;
+	}
+
+	row = lazy->rows + (long) slot * lazy->words;
+	memset(row, 0, sizeof(WORD) * lazy->words);
+	memset(lazy->visited, 0, sizeof(WORD) * lazy->words);
+
+	lazy->visited[vertex / WORD_BITS] |= (WORD) 1 << ( vertex % WORD_BITS );
+	lazy->stack[++top] = vertex;
+	while ( top >= 0 ) {
+		int	u = lazy->stack[top--];
+
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			int	w = graph->edges_index[u][k];
+
+			if ( ( lazy->visited[w / WORD_BITS] >> ( w % WORD_BITS ) ) & 1 ) continue;
+
+			lazy->visited[w / WORD_BITS] |= (WORD) 1 << ( w % WORD_BITS );
+			row[w / WORD_BITS] |= (WORD) 1 << ( w % WORD_BITS );
+
+			// Everything below a cached vertex is already in its row
+			if ( lazy->slot[w] != LAZY_CLOSURE_NONE ) {
+				const WORD	*cached = lazy->rows + (long) lazy->slot[w] * lazy->words;
+
+				kernels.row_union(row, cached, lazy->words);
+				kernels.row_union(lazy->visited, cached, lazy->words);
+				continue;
+			}
+
+			lazy->stack[++top] = w;
+		}
+	}
+
+	// A cycle through vertex brings it back in through a merged row
+	row[vertex / WORD_BITS] &= ~( (WORD) 1 << ( vertex % WORD_BITS ) );
+
+	lazy->slot[vertex] = slot;
+	lazy->owner[slot] = vertex;
+	lazy_closure_link(lazy, slot);
+	return row;
+}
+
+/**
+ * @brief Checks if destination is reachable from source
+ *
+ * @returns 1 if reachable, otherwise 0
+ */
+int lazy_closure_contains(LazyClosure* lazy, int source, int destination) {
+	const WORD	*row = lazy_closure_row(lazy, source);
+
+	return ( row[destination / WORD_BITS] >> ( destination % WORD_BITS ) ) & 1;
+}
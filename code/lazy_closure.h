@@ -0,0 +1,73 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/lazy_closure.h
+ *
+ * @brief Struct of a closure whose rows are computed on demand and kept in a bounded cache
+ *
+ */
+#ifndef LAZY_CLOSURE_H_
+#define LAZY_CLOSURE_H_
+
+	/**
+	 * @name Lazy closure definitions
+	 */
+	/**@{*/
+	#define LAZY_CLOSURE_DEFAULT_BYTES	( 16L << 20 )	/* Bytes of rows kept by graph_closure_contains */
+	#define LAZY_CLOSURE_NONE		-1		/* Vertex without a cached row, or slot without a vertex */
+	/**@}*/
+
+	typedef struct LazyClosure {
+
+		/**
+		 * @name Graph whose closure is computed, its edges must not change meanwhile
+		 */
+		/**@{*/
+		Graph*	graph;
+		int	words;			/* WORDs of a row */
+		/**@}*/
+
+		/**
+		 * @name Cached rows, from the most to the least recently used
+		 */
+		/**@{*/
+		WORD*	rows;			/* capacity rows of words WORDs */
+		int	capacity;		/* Rows that can be cached */
+		int	used;			/* Slots handed out so far */
+		int*	slot;			/* Slot of each vertex, LAZY_CLOSURE_NONE if not cached */
+		int*	owner;			/* Vertex of each slot */
+		int*	newer;			/* Slot used right after each slot, LAZY_CLOSURE_NONE for the newest */
+		int*	older;			/* Slot used right before each slot, LAZY_CLOSURE_NONE for the oldest */
+		int	newest;			/* Slot used last */
+		int	oldest;			/* Slot evicted next */
+		/**@}*/
+
+		/**
+		 * @name Scratch of a search, and counters
+		 */
+		/**@{*/
+		int*	stack;			/* Vertices to expand */
+		WORD*	visited;		/* Vertices reached by the search */
+		long	hits;			/* Rows found in the cache */
+		long	misses;			/* Rows computed */
+		long	evictions;		/* Rows dropped to make room */
+		/**@}*/
+
+	} LazyClosure;
+
+#endif /* LAZY_CLOSURE_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Lazy closure operations
+ */
+/**@{*/
+extern LazyClosure* lazy_closure_initializer(Graph* graph, long bytes);
+extern void lazy_closure_destroy(LazyClosure* lazy);
+extern const WORD* lazy_closure_row(LazyClosure* lazy, int vertex);
+extern int  lazy_closure_contains(LazyClosure* lazy, int source, int destination);
+/**@}*/
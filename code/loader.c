@@ -0,0 +1,283 @@
+#include "graph.h"
+#include "loader.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+int loader_threads = LOADER_AUTO;
+
+/**
+ * @brief Checks if a character separates two tokens, as for fscanf
+ */
+int loader_space(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Next token of a part of the file
+ *
+ * @param cursor Where to start, moved past the token
+ * @param last One past the last byte that can be read
+ * @param length Receives the length of the token
+ *
+ * @returns First character of the token, NULL if there is none left
+ */
+const char* loader_token(const char** cursor, const char* last, int* length) {
+	const char	*c = *cursor,
+			*start = NULL;
+
+	while ( c < last && loader_space(*c) ) c++;
+	start = c;
+	while ( c < last && ! loader_space(*c) ) c++;
+
+	*cursor = c;
+	*length = (int) ( c - start );
+	return *length > 0 ? start : NULL;
+}
+
+/**
+ * @brief Integer written in a token, 0 if there is none as fscanf leaves it
+ */
+int loader_number(const char* token, int length) {
+	char	buffer[STR_SIZE];
+
+	if ( token == NULL || length >= STR_SIZE ) return 0;
+
+	memcpy(buffer, token, length);
+	buffer[length] = '\0';
+	return atoi(buffer);
+}
+
+/**
+ * @brief Position of a vertex named by part of a token, -1 if it is not in graph
+ */
+int loader_find(Graph* graph, const char* name, int length) {
+	char	buffer[STR_SIZE];
+
+	if ( length <= 0 || length >= STR_SIZE ) return -1;
+
+	memcpy(buffer, name, length);
+	buffer[length] = '\0';
+	return graph_vertice_finder(graph, buffer);
+}
+
+/**
+ * @brief Splits an edge token into its two vertices
+ *
+ * @details As strtok does with "-" in main: separators at the start and
+ *          repeated ones are skipped, and anything after the second name is
+ *          ignored. A missing name has length 0.
+ */
+void loader_split(const char* token, int length, const char** source, int* source_length, const char** destination, int* destination_length) {
+	const char	*c = token,
+			*last = token + length;
+
+	while ( c < last && *c == '-' ) c++;
+	for ( *source = c; c < last && *c != '-'; c++ );
+	*source_length = (int) ( c - *source );
+
+	while ( c < last && *c == '-' ) c++;
+	for ( *destination = c; c < last && *c != '-'; c++ );
+	*destination_length = (int) ( c - *destination );
+}
+
+/**
+ * @brief Parses the edges of a chunk, run by each thread
+ *
+ * @details Names are only looked up: every vertex is in the table of the graph
+ *          before any thread starts and nothing changes it while they run, so
+ *          the threads share it without any lock. Each thread writes to its
+ *          own buffers, grown as needed.
+ */
+void* loader_worker(void* argument) {
+	LoaderChunk	*chunk = (LoaderChunk*) argument;
+	const char	*cursor = chunk->first,
+			*token = NULL,
+			*source = NULL,
+			*destination = NULL;
+	int		length = 0,
+			source_length = 0,
+			destination_length = 0;
+
+	while ( ( token = loader_token(&cursor, chunk->last, &length) ) != NULL ) {
+		if ( chunk->amount == chunk->allocated ) {
+			chunk->allocated = 2 * chunk->allocated + 16;
+			chunk->sources = (int*) mem_realloc( chunk->sources, sizeof(int) * chunk->allocated, MEM_SCRATCH );
+			chunk->destinations = (int*) mem_realloc( chunk->destinations, sizeof(int) * chunk->allocated, MEM_SCRATCH );
+		}
+
+		loader_split(token, length, &source, &source_length, &destination, &destination_length);
+		chunk->sources[chunk->amount] = loader_find(chunk->graph, source, source_length);
+		chunk->destinations[chunk->amount] = loader_find(chunk->graph, destination, destination_length);
+
+		if ( chunk->sources[chunk->amount] == -1 || chunk->destinations[chunk->amount] == -1 ) {
+			chunk->sources[chunk->amount] = -1;
+			chunk->tokens = (const char**) mem_realloc( chunk->tokens, sizeof(const char*) * ( chunk->failed + 1 ), MEM_SCRATCH );
+			chunk->tokens[chunk->failed++] = token;
+		}
+		chunk->amount++;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Reads a graph file with several threads
+ *
+ * @param path File in the format main reads: vertices, edges and flag, the
+ *             vertex names, then one "source-destination" per edge
+ * @param threads Number of threads, LOADER_AUTO for one per processor
+ *
+ * @details The file is mapped instead of read. The header and the names are
+ *          read first, in order, as they give every vertex its position. The
+ *          edge list is then cut into chunks of whole lines, at least
+ *          LOADER_MIN_CHUNK bytes each, parsed by one thread each. The buffers
+ *          of the threads are merged in the order of the file, keeping the
+ *          first edges as main did, and the edges inserted at once through
+ *          graph_add_edges. Messages are those of the loop in main, in the
+ *          same order.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* loader_load(const char* path, int threads) {
+	int		fd = open(path, O_RDONLY),
+			vertices = 0,
+			edges = 0,
+			flag = 0,
+			length = 0,
+			amount = 0,
+			control = 0,
+			created = 0;
+	long		size = 0;
+	const char	*text = NULL,
+			*cursor = NULL,
+			*last = NULL,
+			*token = NULL;
+	char		name[STR_SIZE];
+	int		*sources = NULL,
+			*destinations = NULL;
+	LoaderChunk	chunks[LOADER_MAX_THREADS];
+	pthread_t	handles[LOADER_MAX_THREADS];
+	Graph		*g = NULL;
+
+	if ( fd < 0 ) {
+		printf("ERROR: Invalid opening of file\n");
+		return NULL;
+	}
+
+	size = (long) lseek(fd, 0, SEEK_END);
+	text = size > 0 ? (const char*) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+	close(fd);
+
+	if ( text == MAP_FAILED ) {
+		printf("ERROR: Invalid opening of file\n");
+		return NULL;
+	}
+
+	cursor = text;
+	last = text + size;
+	token = loader_token(&cursor, last, &length);
+	vertices = loader_number(token, length);
+	token = loader_token(&cursor, last, &length);
+	edges = loader_number(token, length);
+	token = loader_token(&cursor, last, &length);
+	flag = loader_number(token, length);
+
+	// Basic verifications to make sure that the Graph can be created.
+	if ( vertices <= 0 ) {
+		printf("ERROR: Graph null\n");
+	} else if ( edges <= 0 ) {
+		printf("ERROR: Graph without edges\n");
+	} else if ( flag != NON_DIRECTED && flag != DIRECTED ) {
+		printf("ERROR: Invalid flag\n");
+	} else {
+		g = graph_initializer(vertices, edges, flag);
+	}
+
+	if ( g == NULL ) {
+		if ( text != NULL ) munmap((void*) text, size);
+		return NULL;
+	}
+
+	for ( int i = 0; i < vertices && ( token = loader_token(&cursor, last, &length) ) != NULL; i++ ) {
+		if ( length >= STR_SIZE ) {
+			printf("ERROR: Vertex name (%.*s) longer than %d characters\n", length, token, STR_SIZE - 1);
+			graph_destroy(g);
+			munmap((void*) text, size);
+			return NULL;
+		}
+
+		memcpy(name, token, length);
+		name[length] = '\0';
+		graph_add_vertice(g, name);
+	}
+
+	if ( threads == LOADER_AUTO ) threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if ( threads > LOADER_MAX_THREADS ) threads = LOADER_MAX_THREADS;
+	if ( threads > ( last - cursor ) / LOADER_MIN_CHUNK ) threads = (int) ( ( last - cursor ) / LOADER_MIN_CHUNK );
+	if ( threads < 1 ) threads = 1;
+
+	// Every chunk ends after a newline, so no token is cut in two
+	memset(chunks, 0, sizeof(LoaderChunk) * threads);
+	for ( int t = 0; t < threads; t++ ) {
+		const char	*end = t == threads - 1 ? last : cursor + ( last - cursor ) * ( t + 1 ) / threads;
+
+		while ( end < last && end[-1] != '\n' ) end++;
+
+		chunks[t].first = t == 0 ? cursor : chunks[t - 1].last;
+		chunks[t].last = end > chunks[t].first ? end : chunks[t].first;
+		chunks[t].graph = g;
+	}
+
+	for ( created = 1; created < threads; created++ ) {
+		if ( pthread_create(&handles[created], NULL, loader_worker, &chunks[created]) != 0 ) {
+			printf("WARNING: Loader running with %d threads instead of %d\n", created, threads);
+			break;
+		}
+	}
+
+	// Chunks without a thread are parsed by the caller
+	loader_worker(&chunks[0]);
+	for ( int t = created; t < threads; t++ ) loader_worker(&chunks[t]);
+	for ( int t = 1; t < created; t++ ) pthread_join(handles[t], NULL);
+
+	// Edge reading, inserted all at once when the list is over
+	sources = (int*) mem_malloc( sizeof(int) * edges + 1, MEM_SCRATCH );
+	destinations = (int*) mem_malloc( sizeof(int) * edges + 1, MEM_SCRATCH );
+	for ( int t = 0; t < threads; t++ ) {
+		for ( int k = 0, f = 0; k < chunks[t].amount && control < edges; k++, control++ ) {
+			if ( chunks[t].sources[k] == -1 ) {
+				const char	*failed = chunks[t].tokens[f++],
+						*end = failed,
+						*source = NULL,
+						*destination = NULL;
+				int		source_length = 0,
+						destination_length = 0;
+
+				while ( end < last && ! loader_space(*end) ) end++;
+				loader_split(failed, (int) ( end - failed ), &source, &source_length, &destination, &destination_length);
+				printf("ERROR: Atleast one of your vertices (%.*s - %.*s) was not found in your graph.\n",
+				       source_length, source, destination_length, destination);
+				continue;
+			}
+
+			sources[amount] = chunks[t].sources[k];
+			destinations[amount] = chunks[t].destinations[k];
+			amount++;
+		}
+
+		mem_free(chunks[t].sources);
+		mem_free(chunks[t].destinations);
+		mem_free(chunks[t].tokens);
+	}
+	graph_add_edges(g, sources, destinations, amount);
+
+	mem_free(sources);
+	mem_free(destinations);
+	munmap((void*) text, size);
+	return g;
+}
@@ -0,0 +1,62 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/loader.h
+ *
+ * @brief Struct of a graph file parsed by several threads
+ *
+ */
+#ifndef LOADER_H_
+#define LOADER_H_
+
+	#include <pthread.h>
+
+	/**
+	 * @name Loader definitions
+	 */
+	/**@{*/
+	#define LOADER_AUTO		0		/* One thread per online processor */
+	#define LOADER_MAX_THREADS	64		/* Upper bound on the number of threads */
+	#define LOADER_MIN_CHUNK	( 1 << 10 )	/* Bytes of edges below which no thread is added, about a hundred edges */
+	/**@}*/
+
+	typedef struct LoaderChunk {
+
+		/**
+		 * @name Part of the edge list given to a thread, whole lines only
+		 */
+		/**@{*/
+		const char*	first;		/* First byte */
+		const char*	last;		/* One past the last byte */
+		/**@}*/
+
+		/**
+		 * @name Edges parsed by the thread, in the order of the file
+		 */
+		/**@{*/
+		Graph*		graph;		/* Graph whose names are looked up, not changed while threads run */
+		int*		sources;	/* Source of each edge, -1 if a vertex was not found */
+		int*		destinations;	/* Destination of each edge, -1 if a vertex was not found */
+		const char**	tokens;		/* Edge of each -1, for its message */
+		int		amount;		/* Edges parsed */
+		int		allocated;	/* Capacity of sources and destinations */
+		int		failed;		/* Edges with a vertex not found */
+		/**@}*/
+
+	} LoaderChunk;
+
+	extern int loader_threads;	/* Threads parsing grafo3.txt, LOADER_AUTO for one per processor */
+
+#endif /* LOADER_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Loader operations
+ */
+/**@{*/
+extern Graph* loader_load(const char* path, int threads);
+/**@}*/
@@ -2,108 +2,230 @@
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "graph.h"
 #include "stack.h"
+#include "bitset.h"
+#include "kernels.h"
 #include "walk.h"
+#include "external.h"
+#include "shard.h"
 #include "permutation.h"
+#include "checkpoint.h"
+#include "relabel.h"
+#include "batch.h"
+#include "cache.h"
+#include "stats.h"
+#include "subgraph.h"
+#include "quotient.h"
+#include "witness.h"
+#include "loader.h"
+#include "hugealloc.h"
+#include "memtrack.h"
 
 /**
- * @brief Splits a edge string into pieces containing vertices
- *
- * @param edge to be splitted 
- *
- * @details Receives a line of edge and split it on blank spaces, ex: a-b = 1 (a) 2(b)
- *
+ * @brief Prints the command line options
  */
-char** splitInstruction(char *edge){
-    char    **splitted_string = (char**) malloc(( 2 * (sizeof(char*)) ));
-    char    *delimiter = "-";
-    char    *token;
-    int     aux = 0;
-
-    token = strtok(edge, delimiter);
-    while( token != NULL ) {
-        *splitted_string = (char*) malloc( STR_SIZE * sizeof(char) );
-        strcpy(*splitted_string, token); 
-        splitted_string++;
-        aux++;
-        token = strtok(NULL, delimiter);
-    }    
-
-    splitted_string -= aux;
-    return splitted_string;
+void usage(const char* program) {
+	printf("Usage: %s [-t seconds] [-n tests] [-p seconds] [-c file] [-m megabytes] [-A] [-s] [-r order] [-e engine] [-S storage [-K megabytes]] [-x megabytes [-X file]] [-P workers] [-R roots [-D direction]] [-q] [-W file] [-H] [-N] [-j threads] [-b input [-o directory]] [-C directory [-L megabytes]]\n", program);
+	printf("  -t seconds  stop walk after this wall time, keeping the edges removed so far\n");
+	printf("  -n tests    stop walk after this many edge tests, keeping the edges removed so far\n");
+	printf("  -p seconds  interval between progress reports of walk, 0 for none (default %g)\n", WALK_PROGRESS_INTERVAL);
+	printf("  -c file     journal the reduction to this checkpoint and resume from it if present\n");
+	printf("  -m megabytes warn when tracked memory grows past this ceiling\n");
+	printf("  -A          abort instead of warning when the memory ceiling is crossed\n");
+	printf("  -s          print peak memory and allocations per tag and phase at the end\n");
+	printf("  -r order    relabel vertices before closure and reduction: none, topological, bfs or rcm\n");
+	printf("  -e engine   reduction engine: auto (default, chosen from the statistics of the graph), walk, chain or permutation\n");
+	printf("  -S storage  closure storage: auto (default, chosen from the statistics of the graph), dense, compressed or lazy (rows computed when asked for)\n");
+	printf("  -K megabytes dense closure size from which auto storage compresses a sparse closure (default %g)\n", (double) STATS_DENSE_CLOSURE_BYTES / ( 1 << 20 ));
+	printf("  -x megabytes closure size from which walk computes it on disk instead of in memory (default %g)\n", (double) EXTERNAL_DEFAULT_BUDGET / ( 1 << 20 ));
+	printf("  -X file     file that holds the closure computed on disk, removed at the end (default %s)\n", EXTERNAL_DEFAULT_PATH);
+	printf("  -P workers  reduce acyclic graphs with this many worker processes over shared memory, 0 for none (default)\n");
+	printf("  -R roots    reduce only the region around these vertices, separated by commas\n");
+	printf("  -D direction region kept around the roots: descendants (default), ancestors or induced\n");
+	printf("  -q          merge vertices with the same predecessors and neighbours before the reduction\n");
+	printf("  -W file     write to this file the path that makes each edge removed by walk redundant\n");
+	printf("  -b input    walk every graph of a directory or manifest (one file per line) and exit\n");
+	printf("  -o directory where batch mode writes the reductions and %s (default %s)\n", BATCH_SUMMARY, BATCH_DEFAULT_OUTPUT);
+	printf("  -H          keep closures and adjacency arrays of %ld MB or more off huge pages\n", HUGE_MIN_SIZE >> 20);
+	printf("  -N          interleave the pages of closures and adjacency arrays of %ld MB or more over the NUMA nodes\n", HUGE_MIN_SIZE >> 20);
+	printf("              (no array of a graph below MAX_AMOUNT = %d vertices is that large, so today -H and -N change nothing)\n", MAX_AMOUNT);
+	printf("  -j threads  batch workers and threads parsing the input, 0 for one per processor (default)\n");
+	printf("  -C directory reuse closures and reductions stored in this cache directory\n");
+	printf("  -L megabytes size of the cache, least recently used entries are evicted (default %ld)\n", CACHE_DEFAULT_BUDGET >> 20);
 }
 
-int main(void){
-	int	vertices = 0,
-		edges = 0, 
-		flag = 0, 
-		control = 0;
-	Graph	*g = NULL; 
-	Graph	*cloned = NULL;
-
-	char	vertice[STR_SIZE],
-		edge[STR_SIZE];
-
-	STRING* split_edge;
-	
-	FILE *entrada = fopen("grafo3.txt", "rt");
-	if (entrada == NULL) {
-		printf("ERROR: Invalid opening of file\n");
-	} else {
-		fscanf(entrada, "%d", &vertices);
-		fscanf(entrada, "%d", &edges);
-		fscanf(entrada, "%d", &flag);
+int main(int argc, char** argv){
+	int	control = 0,
+		statistics = 0,
+		opt = 0;
+	Graph	*g = NULL,
+		*original = NULL,
+		*whole = NULL;
+	Quotient	*quotient = NULL;
+	int	*order = NULL,
+		*roots = NULL,
+		roots_amount = 0,
+		engine_selected = STATS_ENGINE_WALK;
+	GraphStats	stats;
+	char	key[CACHE_KEY_SIZE],
+		engine[STR_SIZE];
+	const char	*batch_input = NULL,
+			*batch_output = BATCH_DEFAULT_OUTPUT,
+			*engine_run = NULL;
 
-		// Basic verifications to make sure that the Graph can be created.
-		if (vertices <= 0) {
-			printf("ERROR: Graph null\n");
+	while ( ( opt = getopt(argc, argv, "t:n:p:c:m:Asr:e:S:K:x:X:P:R:D:qW:HNb:o:j:C:L:h") ) != -1 ) {
+		switch ( opt ) {
+			case 't':
+				walk_time_budget = strtod(optarg, NULL);
+				break;
+			case 'n':
+				walk_test_budget = strtol(optarg, NULL, 10);
+				break;
+			case 'p':
+				walk_progress_interval = strtod(optarg, NULL);
+				break;
+			case 'c':
+				checkpoint_path = optarg;
+				break;
+			case 'm':
+				mem_ceiling = (long) ( strtod(optarg, NULL) * 1024 * 1024 );
+				break;
+			case 'A':
+				mem_ceiling_abort = 1;
+				break;
+			case 's':
+				statistics = 1;
+				break;
+			case 'r':
+				if ( ( relabel_order = relabel_parse(optarg) ) < 0 ) return 1;
+				break;
+			case 'e':
+				if ( ( stats_engine = stats_engine_parse(optarg) ) < 0 ) return 1;
+				break;
+			case 'S':
+				if ( ( stats_storage = stats_storage_parse(optarg) ) < STATS_STORAGE_AUTO ) return 1;
+				break;
+			case 'K':
+				stats_dense_bytes = (long) ( strtod(optarg, NULL) * 1024 * 1024 );
+				break;
+			case 'x':
+				external_budget = (long) ( strtod(optarg, NULL) * 1024 * 1024 );
+				break;
+			case 'X':
+				external_path = optarg;
+				break;
+			case 'P':
+				shard_workers = atoi(optarg);
+				break;
+			case 'R':
+				subgraph_roots = optarg;
+				break;
+			case 'D':
+				if ( ( subgraph_direction = subgraph_parse(optarg) ) < 0 ) return 1;
+				break;
+			case 'q':
+				quotient_enabled = 1;
+				break;
+			case 'W':
+				witness_path = optarg;
+				break;
+			case 'H':
+				huge_pages = 0;
+				break;
+			case 'N':
+				huge_interleave = 1;
+				break;
+			case 'b':
+				batch_input = optarg;
+				break;
+			case 'o':
+				batch_output = optarg;
+				break;
+			case 'j':
+				batch_threads = loader_threads = atoi(optarg);
+				break;
+			case 'C':
+				cache_directory = optarg;
+				break;
+			case 'L':
+				cache_budget = (long) ( strtod(optarg, NULL) * 1024 * 1024 );
+				break;
+			default:
+				usage(argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
 
-		} else if (edges <= 0){
-			printf("ERROR: Graph without edges\n");
+	// Row kernels of this host must be chosen before any closure is computed
+	kernels_initializer();
 
-		} else if (flag != 0 && flag != 1){
-			printf("ERROR: Invalid flag\n");
+	// Batch mode replaces the interactive run on grafo3.txt
+	if ( batch_input != NULL ) {
+		mem_phase("batch");
+		control = batch_run(batch_input, batch_output, batch_threads);
+		if ( statistics ) mem_report();
+		return control == 0 ? 0 : 1;
+	}
 
-		} else {
-			// Allocates memory space for graph
-			g = graph_initializer(vertices, edges, flag);
-		
-			// g == NULL only if vertices OR edges > MAX_AMOUNT
-			if ( g != NULL ) {
-				// Vertex reading
-				while ( ! feof(entrada) && control < vertices) {
-					strcpy(vertice, "");
-					fscanf(entrada, "%s", vertice);
-					graph_add_vertice(g, vertice);
-					control++;
-				}
-
-				// Edge reading
-				control = 0;
-				while ( ! feof(entrada) && control < edges) {
-					strcpy(edge, "");
-					fscanf(entrada, "%s", edge);
-					split_edge = splitInstruction(edge);
-					graph_add_edge(g, split_edge[0], split_edge[1]);
-					control++;
-				}
-				cloned = graph_clone(g);
-		                printf("ORIGINAL GRAPH\n");
-				graph_print_vertices(g);
-				graph_print_edges(g);
-
-
-			} // Ending Graph null verification
-		} // Ending Graph's variables verification
-	} // Ending file properly opened verification
-
-
-	// Testing direct transitive closure
-	direct_transitive_closure(g);
-	//graph_print_direct_transitive_closure(g);
+	mem_phase("load");
+	g = loader_load("grafo3.txt", loader_threads);
+	if ( g != NULL ) {
+		printf("ORIGINAL GRAPH\n");
+		graph_print_vertices(g);
+		graph_print_edges(g);
+	}
+
+	// Only the region around the roots is reduced, the rest of the graph is dropped
+	if ( g != NULL && subgraph_roots != NULL ) {
+		Graph	*sub = NULL;
+
+		mem_phase("subgraph");
+		if ( ( roots = subgraph_find_roots(g, subgraph_roots, &roots_amount) ) == NULL ) return 1;
+		if ( ( sub = subgraph_extract(g, roots, roots_amount, subgraph_direction) ) == NULL ) return 1;
+
+		printf("\nSubgraph around %s: %d of %d vertices, %d of %d edges\n", subgraph_roots,
+		       sub->vertices_amount, g->vertices_amount, sub->edges_amount, g->edges_amount);
+		mem_free(roots);
+		graph_destroy(g);
+		g = sub;
+	}
+
+	// Engines reduce one vertex per class of equivalent vertices, their results are expanded back
+	if ( g != NULL && quotient_enabled ) {
+		mem_phase("quotient");
+		if ( ( quotient = quotient_compute(g) ) != NULL ) {
+			whole = g;
+			g = quotient_apply(whole, quotient);
+			printf("\nQuotient: %d of %d vertices, %d of %d edges\n", g->vertices_amount, whole->vertices_amount,
+			       g->edges_amount, whole->edges_amount);
+		}
+	}
+
+	// Engines run on the relabelled graph, their results are brought back to the input order
+	if ( g != NULL && relabel_order != RELABEL_NONE ) {
+		mem_phase("relabel");
+		order = relabel_compute(g, relabel_order);
+		original = g;
+		g = relabel_apply(original, order);
+	}
 
-	direct_transitive_closure(cloned);
+	// Engine and closure representation follow the shape of the graph, unless -e forces one
+	if ( g != NULL ) {
+		stats_compute(g, &stats);
+		stats_print(&stats);
+		engine_selected = stats_select(g, &stats, stats_engine);
+	}
+
+	// Testing direct transitive closure, unless the cache already has it or its rows are computed on demand
+	mem_phase("closure");
+	if ( cache_directory != NULL ) cache_key(g, key);
+	if ( g->closure_storage != CLOSURE_LAZY && ( cache_directory == NULL || cache_load_closure(key, g) != 0 ) ) {
+		direct_transitive_closure(g);
+		if ( cache_directory != NULL ) cache_store_closure(key, g);
+	}
+	//graph_print_direct_transitive_closure(g);
 
 	Graph *pTR = NULL;
 
@@ -111,13 +233,39 @@ int main(void){
 	if ( !isCyclic(g) ) {
 		clock_t start, end;
 		double duration;
-		int option = 0;
-		printf("\nWalk 1: \nPermutate 2:\nOption: ");
-		scanf("%d", &option);
-		switch(option){
-			case 1:
+		switch(engine_selected){
+			case STATS_ENGINE_WALK:
+			case STATS_ENGINE_CHAIN:
 			    start = clock();
-			    Graph *tr = walk(g);
+			    mem_phase("walk");
+			    // Witnesses are only written by a reduction that runs
+			    Graph *tr = cache_directory != NULL && witness_path == NULL ? cache_load_reduction(key, "walk", original != NULL ? original : g) : NULL;
+			    if (tr != NULL) {
+			        printf("Transitive Reduction read from the cache (%s)\n", cache_directory);
+			    } else {
+			        tr = walk(g, &engine_run);
+			        if (tr == NULL) break;
+			        // The options and the fallbacks of walk may run another engine than the one chosen
+			        printf("Engine run: %s\n", engine_run);
+			        if (order != NULL) {
+			            Graph *relabelled = tr;
+
+			            tr = relabel_restore(relabelled, original, order);
+			            graph_destroy(relabelled);
+			        }
+			        // A reduction stopped by a budget is not the reduction of the graph
+			        if (cache_directory != NULL && walk_time_budget == WALK_UNLIMITED && walk_test_budget == WALK_UNLIMITED) {
+			            cache_store_reduction(key, "walk", tr);
+			        }
+			    }
+			    if (quotient != NULL) {
+			        Graph *collapsed = tr;
+
+			        tr = quotient_expand(collapsed, whole, quotient);
+			        graph_destroy(collapsed);
+			        if (tr == NULL) break;
+			    }
+			    mem_phase("output");
 			    graph_print_vertices(tr);
 			    graph_print_edges(tr);
 			    end = clock();
@@ -125,9 +273,33 @@ int main(void){
 			    printf("Time to get Transitive Reduction through Walking in seconds: %g\n", duration);
 			    break;
 
-			case 2:
+			case STATS_ENGINE_PERMUTATION:
 			    start = clock();
-			    pTR = permutation(g);
+			    mem_phase("permutation");
+			    // The result of permutation may depend on the vertex order, see relabel
+			    snprintf(engine, STR_SIZE, relabel_order == RELABEL_NONE ? "permutation" : "permutation-r%d", relabel_order);
+			    pTR = cache_directory != NULL ? cache_load_reduction(key, engine, original != NULL ? original : g) : NULL;
+			    if (pTR != NULL) {
+			        printf("Transitive Reduction read from the cache (%s)\n", cache_directory);
+			    } else {
+			        pTR = permutation(g);
+			        if (pTR == NULL) break;
+			        if (order != NULL) {
+			            Graph *relabelled = pTR;
+
+			            pTR = relabel_restore(relabelled, original, order);
+			            graph_destroy(relabelled);
+			        }
+			        if (cache_directory != NULL) cache_store_reduction(key, engine, pTR);
+			    }
+			    if (quotient != NULL) {
+			        Graph *collapsed = pTR;
+
+			        pTR = quotient_expand(collapsed, whole, quotient);
+			        graph_destroy(collapsed);
+			        if (pTR == NULL) break;
+			    }
+			    mem_phase("output");
 			    graph_print_vertices(pTR);
 			    graph_print_edges(pTR);
 
@@ -138,8 +310,6 @@ int main(void){
 			    printf("Time to get Transitive Reduction through Permutation in seconds: %g\n", duration);
 			    break;
 
-			default:
-			    printf("Invalid option!!!\n");
 	       }
 	} else {
 		printf("ERROR: Your graph contains cycle! Analysis can't be done.\n");
@@ -149,6 +319,9 @@ int main(void){
 		printf("\nFecho transitivo direto igual \\o/\n\n");
 	}*/
 
-	fclose(entrada);
+	mem_free(order);
+	quotient_destroy(quotient);
+	if ( statistics ) mem_report();
+
 	return 0;	
 }
@@ -0,0 +1,211 @@
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+long mem_ceiling = MEM_NO_CEILING;
+int  mem_ceiling_abort = 0;
+
+static const char*	mem_tag_names[MEM_TAGS] = { "graph", "closure", "paths", "stack", "scratch" };
+static MemoryStats	mem_tags[MEM_TAGS];
+static MemoryPhase	mem_phases[MEM_MAX_PHASES] = { { "start", { { 0, 0, 0 } }, 0 } };
+static int		mem_phases_amount = 1;
+static long		mem_total = 0;
+static long		mem_total_peak = 0;
+static int		mem_over_ceiling = 0;
+static pthread_mutex_t	mem_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Header stored before every tracked block
+ *
+ * @details Two words, so the block keeps the alignment of malloc
+ */
+typedef struct MemoryBlock {
+	size_t	size;
+	long	tag;
+} MemoryBlock;
+
+/**
+ * @brief Accounts for size bytes allocated (positive) or freed (negative) with a tag
+ *
+ * @details Called by the functions below, and for blocks allocated some other
+ *          way, see hugealloc.c
+ */
+void mem_account(long size, int tag) {
+	MemoryPhase	*phase = NULL;
+	const char	*phase_name = NULL;
+	long		total = 0;
+	int		crossed = 0;
+
+	pthread_mutex_lock(&mem_lock);
+	phase = &mem_phases[mem_phases_amount - 1];
+	mem_tags[tag].current += size;
+	mem_total += size;
+
+	if ( size > 0 ) {
+		mem_tags[tag].allocations++;
+		phase->tags[tag].allocations++;
+		if ( mem_tags[tag].current > mem_tags[tag].peak ) mem_tags[tag].peak = mem_tags[tag].current;
+		if ( mem_tags[tag].current > phase->tags[tag].peak ) phase->tags[tag].peak = mem_tags[tag].current;
+		if ( mem_total > mem_total_peak ) mem_total_peak = mem_total;
+		if ( mem_total > phase->peak ) phase->peak = mem_total;
+	}
+
+	// Reported once per crossing, not on every allocation above the ceiling
+	if ( mem_ceiling > MEM_NO_CEILING ) {
+		if ( mem_total > mem_ceiling && ! mem_over_ceiling ) crossed = 1;
+		mem_over_ceiling = mem_total > mem_ceiling;
+	}
+	total = mem_total;
+	phase_name = phase->name;
+	pthread_mutex_unlock(&mem_lock);
+
+	if ( crossed ) {
+		printf("%s: Tracked memory (%ld bytes) crossed the ceiling (%ld bytes) allocating %ld bytes of %s in phase %s\n",
+		       mem_ceiling_abort ? "ERROR" : "WARNING", total, mem_ceiling, size, mem_tag_names[tag], phase_name);
+		if ( mem_ceiling_abort ) {
+			mem_report();
+			fflush(stdout);
+			abort();
+		}
+	}
+}
+
+/**
+ * @brief Allocates size bytes accounted to a tag
+ *
+ * @returns Reference to the block, NULL on ERROR
+ */
+void* mem_malloc(size_t size, int tag) {
+	MemoryBlock	*block = (MemoryBlock*) malloc( sizeof(MemoryBlock) + size );
+
+	if ( block == NULL ) return NULL;
+
+	block->size = size;
+	block->tag = tag;
+	mem_account((long) size, tag);
+	return block + 1;
+}
+
+/**
+ * @brief Allocates amount zeroed elements of size bytes accounted to a tag
+ *
+ * @returns Reference to the block, NULL on ERROR
+ */
+void* mem_calloc(size_t amount, size_t size, int tag) {
+	MemoryBlock	*block = (MemoryBlock*) calloc( 1, sizeof(MemoryBlock) + amount * size );
+
+	if ( block == NULL ) return NULL;
+
+	block->size = amount * size;
+	block->tag = tag;
+	mem_account((long) block->size, tag);
+	return block + 1;
+}
+
+/**
+ * @brief Resizes a tracked block, keeping the tag it was allocated with
+ *
+ * @details A NULL pointer is allocated with the given tag, as realloc does
+ *
+ * @returns Reference to the block, NULL on ERROR
+ */
+void* mem_realloc(void* pointer, size_t size, int tag) {
+	MemoryBlock	*block = NULL;
+	size_t		old_size = 0;
+
+	if ( pointer == NULL ) return mem_malloc(size, tag);
+
+	block = (MemoryBlock*) pointer - 1;
+	old_size = block->size;
+	tag = (int) block->tag;
+	block = (MemoryBlock*) realloc( block, sizeof(MemoryBlock) + size );
+	if ( block == NULL ) return NULL;
+
+	block->size = size;
+	mem_account(-(long) old_size, tag);
+	mem_account((long) size, tag);
+	return block + 1;
+}
+
+/**
+ * @brief Frees a tracked block, NULL is ignored
+ */
+void mem_free(void* pointer) {
+	MemoryBlock	*block = NULL;
+
+	if ( pointer == NULL ) return;
+
+	block = (MemoryBlock*) pointer - 1;
+	mem_account(-(long) block->size, (int) block->tag);
+	free(block);
+}
+
+/**
+ * @brief Starts a new phase of the run
+ *
+ * @param name Name shown in the report, must outlive the run
+ *
+ * @details Once MEM_MAX_PHASES are in use, later phases add to the last one,
+ *          renamed MEM_MERGED_PHASE: its allocations are summed and its peaks
+ *          are the highest of all of them.
+ */
+void mem_phase(const char* name) {
+	MemoryPhase	*phase = NULL;
+
+	pthread_mutex_lock(&mem_lock);
+	if ( mem_phases_amount == MEM_MAX_PHASES ) {
+		mem_phases[MEM_MAX_PHASES - 1].name = MEM_MERGED_PHASE;
+		pthread_mutex_unlock(&mem_lock);
+		return;
+	}
+
+	phase = &mem_phases[mem_phases_amount++];
+	phase->name = name;
+	phase->peak = mem_total;
+	for ( int t = 0; t < MEM_TAGS; t++ ) {
+		phase->tags[t].current = 0;
+		phase->tags[t].peak = mem_tags[t].current;
+		phase->tags[t].allocations = 0;
+	}
+	pthread_mutex_unlock(&mem_lock);
+}
+
+/**
+ * @brief Bytes of tracked memory in use
+ */
+long mem_current(void) {
+	long	current = 0;
+
+	pthread_mutex_lock(&mem_lock);
+	current = mem_total;
+	pthread_mutex_unlock(&mem_lock);
+	return current;
+}
+
+/**
+ * @brief Prints current and peak bytes and allocation counts per tag and per phase
+ */
+void mem_report(void) {
+	pthread_mutex_lock(&mem_lock);
+
+	printf("\nMEMORY BY TAG\n%-10s %14s %14s %12s\n", "tag", "current", "peak", "allocations");
+	for ( int t = 0; t < MEM_TAGS; t++ ) {
+		printf("%-10s %14ld %14ld %12ld\n", mem_tag_names[t], mem_tags[t].current, mem_tags[t].peak, mem_tags[t].allocations);
+	}
+	printf("%-10s %14ld %14ld\n", "total", mem_total, mem_total_peak);
+
+	printf("\nMEMORY BY PHASE (peak bytes / allocations)\n%-10s %14s", "phase", "total");
+	for ( int t = 0; t < MEM_TAGS; t++ ) printf(" %20s", mem_tag_names[t]);
+	printf("\n");
+	for ( int p = 0; p < mem_phases_amount; p++ ) {
+		printf("%-10s %14ld", mem_phases[p].name, mem_phases[p].peak);
+		for ( int t = 0; t < MEM_TAGS; t++ ) {
+			printf(" %12ld / %5ld", mem_phases[p].tags[t].peak, mem_phases[p].tags[t].allocations);
+		}
+		printf("\n");
+	}
+
+	pthread_mutex_unlock(&mem_lock);
+}
@@ -0,0 +1,77 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/memtrack.h
+ *
+ * @brief Struct of the accounting of tracked allocations
+ *
+ */
+#ifndef MEMTRACK_H_
+#define MEMTRACK_H_
+
+	#include <stddef.h>
+
+	/**
+	 * @name Memory tracking definitions
+	 */
+	/**@{*/
+	#define MEM_GRAPH		0		/* Vertices, edges and views of graphs */
+	#define MEM_CLOSURE		1		/* Transitive closures, whatever their storage */
+	#define MEM_PATHS		2		/* Paths stored by the permutation method */
+	#define MEM_STACK		3		/* Stacks */
+	#define MEM_SCRATCH		4		/* Short-lived buffers of the algorithms */
+	#define MEM_TAGS		5		/* Number of tags */
+	#define MEM_MAX_PHASES		16		/* Phases kept apart in the report, later ones are merged in the last */
+	#define MEM_MERGED_PHASE	"later"		/* Name of the last phase once later ones are merged in it */
+	#define MEM_NO_CEILING		0		/* No limit on tracked memory */
+	/**@}*/
+
+	typedef struct MemoryStats {
+
+		/**
+		 * @name Accounting of a tag
+		 */
+		/**@{*/
+		long	current;		/* Bytes allocated and not freed yet */
+		long	peak;			/* Highest value of current */
+		long	allocations;		/* Number of allocations */
+		/**@}*/
+
+	} MemoryStats;
+
+	typedef struct MemoryPhase {
+
+		/**
+		 * @name Accounting of a phase of the run
+		 */
+		/**@{*/
+		const char*	name;			/* Name given to mem_phase */
+		MemoryStats	tags[MEM_TAGS];		/* Peak and allocations of each tag during the phase */
+		long		peak;			/* Highest number of bytes of all tags during the phase */
+		/**@}*/
+
+	} MemoryPhase;
+
+	extern long mem_ceiling;	/* Bytes of tracked memory allowed, MEM_NO_CEILING for no limit */
+	extern int  mem_ceiling_abort;	/* 1 to abort when the ceiling is crossed, 0 to warn */
+
+#endif /* MEMTRACK_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Memory tracking operations
+ */
+/**@{*/
+extern void* mem_malloc(size_t size, int tag);
+extern void* mem_calloc(size_t amount, size_t size, int tag);
+extern void* mem_realloc(void* pointer, size_t size, int tag);
+extern void  mem_free(void* pointer);
+extern void  mem_account(long size, int tag);
+extern void  mem_phase(const char* name);
+extern long  mem_current(void);
+extern void  mem_report(void);
+/**@}*/
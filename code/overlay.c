@@ -0,0 +1,372 @@
+#include "graph.h"
+#include "bitset.h"
+#include "overlay.h"
+#include "topology.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Returns the first slot to probe for a key
+ *
+ * @details Fibonacci hashing, allocated is a power of two
+ */
+int edgeset_slot(EdgeSet* set, long key) {
+	return (int) ( ( (unsigned long) key * 0x9E3779B97F4A7C15UL ) >> 32 ) & ( set->allocated - 1 );
+}
+
+/**
+ * @brief Checks if a key is in the set
+ *
+ * @returns 1 if found, otherwise 0
+ */
+int edgeset_contains(EdgeSet* set, long key) {
+	if ( set->amount == 0 ) return 0;
+
+	for ( int i = edgeset_slot(set, key); set->keys[i] != EDGESET_EMPTY; i = ( i + 1 ) & ( set->allocated - 1 ) ) {
+		if ( set->keys[i] == key ) return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Rebuilds the slots with given capacity, dropping removed markers
+ */
+void edgeset_resize(EdgeSet* set, int allocated) {
+	long	*old_keys = set->keys;
+	int	old_allocated = set->allocated;
+
+	set->keys = (long*) mem_malloc( sizeof(long) * allocated, MEM_GRAPH );
+	set->allocated = allocated;
+	set->amount = 0;
+	set->used = 0;
+	for ( int i = 0; i < allocated; i++ ) set->keys[i] = EDGESET_EMPTY;
+
+	for ( int i = 0; i < old_allocated; i++ ) {
+		if ( old_keys[i] >= 0 ) edgeset_insert(set, old_keys[i]);
+	}
+
+	mem_free(old_keys);
+}
+
+/**
+ * @brief Inserts a key in the set, nothing happens if it is already there
+ *
+ * @details Slots are allocated on the first insertion and doubled when more
+ *          than 70% of them are used.
+ */
+void edgeset_insert(EdgeSet* set, long key) {
+	int	i = 0;
+
+	if ( edgeset_contains(set, key) ) return;
+
+	if ( set->allocated == 0 ) {
+		edgeset_resize(set, EDGESET_MIN_SIZE);
+	} else if ( ( set->used + 1 ) * 10 > set->allocated * 7 ) {
+		edgeset_resize(set, ( set->amount + 1 ) * 10 > set->allocated * 3 ? set->allocated * 2 : set->allocated);
+	}
+
+	for ( i = edgeset_slot(set, key); set->keys[i] >= 0; i = ( i + 1 ) & ( set->allocated - 1 ) );
+
+	if ( set->keys[i] == EDGESET_EMPTY ) set->used++;
+	set->keys[i] = key;
+	set->amount++;
+}
+
+/**
+ * @brief Removes a key from the set
+ *
+ * @returns 1 if the key was in the set, otherwise 0
+ */
+int edgeset_remove(EdgeSet* set, long key) {
+	if ( set->amount == 0 ) return 0;
+
+	for ( int i = edgeset_slot(set, key); set->keys[i] != EDGESET_EMPTY; i = ( i + 1 ) & ( set->allocated - 1 ) ) {
+		if ( set->keys[i] == key ) {
+			set->keys[i] = EDGESET_REMOVED;
+			set->amount--;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Frees the slots of a set, leaving it empty
+ */
+void edgeset_free(EdgeSet* set) {
+	mem_free(set->keys);
+	set->keys = NULL;
+	set->amount = 0;
+	set->used = 0;
+	set->allocated = 0;
+}
+
+/**
+ * @brief Initializes a view over a graph
+ *
+ * @param base Graph the view is built on
+ *
+ * @details Nothing of the base graph is copied, so creating a view costs
+ *          O(1) and many views can share the same base graph. The base graph
+ *          must not change while views over it are in use.
+ *
+ * @returns Reference to newly create Overlay
+ */
+Overlay* overlay_initializer(Graph* base) {
+	Overlay	*view = (Overlay*) mem_calloc( 1, sizeof(Overlay), MEM_GRAPH );
+
+	view->base = base;
+	view->edges_amount = 0;
+	for ( int i = 0; i < base->vertices_amount; i++ ) {
+		view->edges_amount += base->edges_neighbours[i];
+	}
+	if ( base->flag == NON_DIRECTED ) view->edges_amount /= 2;
+
+	return view;
+}
+
+/**
+ * @brief Frees a view, the base graph is left untouched
+ */
+void overlay_destroy(Overlay* view) {
+	if ( view == NULL ) return;
+
+	edgeset_free(&view->deleted);
+	edgeset_free(&view->added);
+	mem_free(view->added_source);
+	mem_free(view->added_destination);
+	mem_free(view);
+}
+
+/**
+ * @brief Key of an edge in the EdgeSets of a view
+ */
+long overlay_key(Overlay* view, int source, int destination) {
+	return (long) source * view->base->vertices_amount + destination;
+}
+
+/**
+ * @brief Checks if the view has an edge
+ *
+ * @param view View to be iterated
+ * @param source Position of the source vertice
+ * @param destination Position of the destination vertice
+ *
+ * @returns 1 if the edge is in the view, otherwise 0
+ */
+int overlay_has_edge(Overlay* view, int source, int destination) {
+	long	key = overlay_key(view, source, destination);
+
+	if ( edgeset_contains(&view->added, key) ) return 1;
+
+	return graph_has_edge(view->base, source, destination) != -1 && ! edgeset_contains(&view->deleted, key);
+}
+
+/**
+ * @brief Removes one direction of an edge from the view
+ */
+void overlay_delete_direction(Overlay* view, int source, int destination) {
+	long	key = overlay_key(view, source, destination);
+
+	if ( edgeset_remove(&view->added, key) ) {
+		// Keep the insertion order of the remaining added edges
+		for ( int i = 0; i < view->added.amount + 1; i++ ) {
+			if ( view->added_source[i] == source && view->added_destination[i] == destination ) {
+				memmove(view->added_source + i, view->added_source + i + 1, sizeof(int) * ( view->added.amount - i ));
+				memmove(view->added_destination + i, view->added_destination + i + 1, sizeof(int) * ( view->added.amount - i ));
+				break;
+			}
+		}
+	} else {
+		edgeset_insert(&view->deleted, key);
+	}
+}
+
+/**
+ * @brief Removes an edge from the view
+ *
+ * @param view View that will have the edge removed
+ * @param source Position of the source vertice
+ * @param destination Position of the destination vertice
+ *
+ * @details Both directions are removed when the base graph is undirected,
+ *          as graph_add_edge inserts both of them. Removing an edge that is
+ *          not in the view does nothing.
+ */
+void overlay_delete_edge(Overlay* view, int source, int destination) {
+	if ( ! overlay_has_edge(view, source, destination) ) return;
+
+	overlay_delete_direction(view, source, destination);
+	if ( view->base->flag == NON_DIRECTED ) {
+		overlay_delete_direction(view, destination, source);
+	}
+	view->edges_amount--;
+}
+
+/**
+ * @brief Inserts one direction of an edge in the view
+ */
+void overlay_add_direction(Overlay* view, int source, int destination) {
+	long	key = overlay_key(view, source, destination);
+
+	if ( edgeset_remove(&view->deleted, key) ) return;
+
+	if ( view->added.amount == view->added_allocated ) {
+		view->added_allocated = view->added_allocated == 0 ? EDGESET_MIN_SIZE : view->added_allocated * 2;
+		view->added_source = (int*) mem_realloc( view->added_source, sizeof(int) * view->added_allocated, MEM_GRAPH );
+		view->added_destination = (int*) mem_realloc( view->added_destination, sizeof(int) * view->added_allocated, MEM_GRAPH );
+	}
+	view->added_source[view->added.amount] = source;
+	view->added_destination[view->added.amount] = destination;
+	edgeset_insert(&view->added, key);
+}
+
+/**
+ * @brief Inserts an edge in the view
+ *
+ * @param view View that will have the new edge
+ * @param source Position of the source vertice
+ * @param destination Position of the destination vertice
+ *
+ * @details Inserting an edge of the base graph that was removed only drops
+ *          its removal. Inserting an edge already in the view does nothing.
+ */
+void overlay_add_edge(Overlay* view, int source, int destination) {
+	if ( overlay_has_edge(view, source, destination) ) return;
+
+	overlay_add_direction(view, source, destination);
+	if ( view->base->flag == NON_DIRECTED ) {
+		overlay_add_direction(view, destination, source);
+	}
+	view->edges_amount++;
+}
+
+/**
+ * @brief Lists the neighbours of a vertice in the view
+ *
+ * @param view View to be iterated
+ * @param vertice Position of the vertice
+ * @param neighbours Receives the positions of the neighbours, room for every vertex
+ *
+ * @details Neighbours of the base graph come first, in their order, followed
+ *          by the added ones in insertion order.
+ *
+ * @returns Number of neighbours
+ */
+int overlay_neighbours(Overlay* view, int vertice, int* neighbours) {
+	Graph	*base = view->base;
+	int	amount = 0;
+
+	for ( int k = 0; k < base->edges_neighbours[vertice]; k++ ) {
+		int	destination = base->edges_index[vertice][k];
+
+		if ( view->deleted.amount == 0 || ! edgeset_contains(&view->deleted, overlay_key(view, vertice, destination)) ) {
+			neighbours[amount++] = destination;
+		}
+	}
+
+	for ( int i = 0; i < view->added.amount; i++ ) {
+		if ( view->added_source[i] == vertice ) {
+			neighbours[amount++] = view->added_destination[i];
+		}
+	}
+
+	return amount;
+}
+
+/**
+ * @brief Transitive closure of the view as bit rows
+ *
+ * @param view View to be iterated
+ *
+ * @details Depth-first search from every vertex. As in direct_transitive_closure
+ *          a vertex is not part of its own closure. Views without added edges
+ *          go through the specialised kernels of topology_closure.
+ *
+ * @returns Matrix with row i column j set if j is reachable from i
+ */
+BitMatrix* overlay_closure(Overlay* view) {
+	Topology	*topology = topology_build(view);
+
+	if ( topology != NULL ) {
+		BitMatrix	*closure = topology_closure(topology);
+
+		topology_destroy(topology);
+		return closure;
+	}
+
+	int	n = view->base->vertices_amount,
+		top = -1,
+		amount = 0;
+	BitMatrix	*closure = bitmatrix_initializer(n);
+	int	*stack = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*neighbours = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+
+	for ( int i = 0; i < n; i++ ) {
+		stack[++top] = i;
+
+		while ( top >= 0 ) {
+			amount = overlay_neighbours(view, stack[top--], neighbours);
+
+			for ( int k = 0; k < amount; k++ ) {
+				if ( neighbours[k] != i && ! bitmatrix_test(closure, i, neighbours[k]) ) {
+					bitmatrix_set(closure, i, neighbours[k]);
+					stack[++top] = neighbours[k];
+				}
+			}
+		}
+	}
+
+	mem_free(stack);
+	mem_free(neighbours);
+	return closure;
+}
+
+/**
+ * @brief Builds a standalone graph with the edges of the view
+ *
+ * @param view View to be copied
+ *
+ * @returns Reference to newly create Graph
+ */
+Graph* overlay_materialise(Overlay* view) {
+	Graph	*base = view->base,
+		*g = graph_initializer(base->vertices_amount, base->edges_amount, base->flag);
+	int	*neighbours = (int*) mem_malloc( sizeof(int) * base->vertices_amount + 1, MEM_SCRATCH ),
+		amount = 0;
+
+	for ( int i = 0; i < base->vertices_amount; i++ ) {
+		graph_add_vertice(g, base->vertices[i]);
+	}
+
+	// Both directions of undirected edges are listed, so each list is copied as it is
+	for ( int i = 0; i < base->vertices_amount; i++ ) {
+		amount = overlay_neighbours(view, i, neighbours);
+
+		// Added edges follow the sorted ones of the base, they are moved to their place
+		for ( int k = 1; k < amount && view->added.amount > 0; k++ ) {
+			int	neighbour = neighbours[k],
+				position = k;
+
+			for ( ; position > 0 && neighbours[position - 1] > neighbour; position-- ) {
+				neighbours[position] = neighbours[position - 1];
+			}
+			neighbours[position] = neighbour;
+		}
+
+		for ( int k = 0; k < amount; k++ ) {
+			g->edges[i][k] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_GRAPH );
+			strcpy( g->edges[i][k], base->vertices[neighbours[k]] );
+			g->edges_index[i][k] = neighbours[k];
+		}
+		g->edges_neighbours[i] = amount;
+	}
+	g->edges_amount = view->edges_amount;
+
+	mem_free(neighbours);
+	return g;
+}
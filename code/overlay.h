@@ -0,0 +1,96 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/overlay.h
+ *
+ * @brief Struct of a copy-on-write view over an immutable graph
+ *
+ */
+#ifndef OVERLAY_H_
+#define OVERLAY_H_
+
+	/**
+	 * @name Overlay definitions
+	 */
+	/**@{*/
+	#define EDGESET_EMPTY		-1		/* Free slot of an EdgeSet */
+	#define EDGESET_REMOVED		-2		/* Slot whose key was removed, kept so probing goes on */
+	#define EDGESET_MIN_SIZE	16		/* Slots allocated by the first insertion */
+	/**@}*/
+
+	typedef struct EdgeSet {
+
+		/**
+		 * @name Open addressing set of edge keys (source * vertices + destination)
+		 */
+		/**@{*/
+		long*	keys;			/* Slots, NULL until the first insertion */
+		int	amount;			/* Number of keys in the set */
+		int	used;			/* Number of slots holding a key or EDGESET_REMOVED */
+		int	allocated;		/* Number of slots, always a power of two */
+		/**@}*/
+
+	} EdgeSet;
+
+	typedef struct Overlay {
+
+		/**
+		 * @name Base graph
+		 */
+		/**@{*/
+		Graph*	base;			/* Graph the view is built on, never modified through the view */
+		/**@}*/
+
+		/**
+		 * @name Changes recorded over the base graph
+		 */
+		/**@{*/
+		EdgeSet	deleted;		/* Edges of the base graph removed from the view */
+		EdgeSet	added;			/* Edges of the view missing from the base graph */
+		int*	added_source;		/* Added edges in insertion order, source vertices */
+		int*	added_destination;	/* Added edges in insertion order, destination vertices */
+		int	added_allocated;	/* Capacity of the insertion order arrays */
+		int	edges_amount;		/* Number of edges of the view, as Graph::edges_amount */
+		/**@}*/
+
+		/**
+		 * @name Journal of the reduction working on the view
+		 */
+		/**@{*/
+		struct Checkpoint*	checkpoint;	/* Receives the edges removed, NULL for none, see checkpoint.h */
+		struct Witness*		witness;	/* Receives the path that made each edge redundant, NULL for none, see witness.h */
+		/**@}*/
+
+	} Overlay;
+
+#endif /* OVERLAY_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name EdgeSet operations
+ */
+/**@{*/
+extern int  edgeset_contains(EdgeSet* set, long key);
+extern void edgeset_insert(EdgeSet* set, long key);
+extern int  edgeset_remove(EdgeSet* set, long key);
+extern void edgeset_free(EdgeSet* set);
+/**@}*/
+
+/**
+ * @name Overlay operations
+ */
+/**@{*/
+extern Overlay* overlay_initializer(Graph* base);
+extern void overlay_destroy(Overlay* view);
+extern long overlay_key(Overlay* view, int source, int destination);
+extern int  overlay_has_edge(Overlay* view, int source, int destination);
+extern void overlay_delete_edge(Overlay* view, int source, int destination);
+extern void overlay_add_edge(Overlay* view, int source, int destination);
+extern int  overlay_neighbours(Overlay* view, int vertice, int* neighbours);
+extern struct BitMatrix* overlay_closure(Overlay* view);
+extern Graph* overlay_materialise(Overlay* view);
+/**@}*/
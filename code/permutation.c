@@ -1,8 +1,13 @@
 #include "graph.h"
+#include "bitset.h"
+#include "overlay.h"
 #include "permutation.h"
+#include "checkpoint.h"
+#include "memtrack.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 /**
  * @brief   Initializes the structure containing valid permuted paths between 
@@ -12,59 +17,135 @@
  *                          vertices, according to the total number of vertices
  * 
  * @details Allocates memory space for structure containing valid permuted 
- *          paths between two vertices
+ *          paths between two vertices. Only PATHS_INITIAL paths are allocated,
+ *          path_add grows the arrays up to number_of_paths as they fill.
  *
- * @returns Reference to newly create Paths
+ * @returns Reference to newly create Paths, NULL if the memory could not be allocated
  */
 
 Paths* path_initializer(int number_of_paths) {
 
-	Paths *p = (Paths*) malloc( sizeof(Paths) );
+	Paths *p = (Paths*) mem_malloc( sizeof(Paths), MEM_PATHS );
+    int allocated = number_of_paths < PATHS_INITIAL ? number_of_paths : PATHS_INITIAL;
+
+    if (p == NULL) {
+        return NULL;
+    }
 
     p->position_greatest_path = -1;
-    p->paths_allocated = number_of_paths;
+    p->paths_allocated = allocated;
+    p->paths_limit = number_of_paths;
     p->amount_paths = 0;
 
-    p->number_edges = (int*) calloc( number_of_paths, sizeof(int) );
-    p->paths = (STRING**) malloc( sizeof(STRING*) * number_of_paths);
+    p->number_edges = (int*) mem_calloc( allocated, sizeof(int), MEM_PATHS );
+    p->paths = (STRING**) mem_malloc( sizeof(STRING*) * allocated, MEM_PATHS);
+    p->positions = (int**) mem_malloc( sizeof(int*) * allocated, MEM_PATHS);
+    p->sorted = (int**) mem_malloc( sizeof(int*) * allocated, MEM_PATHS);
+
+    if (p->number_edges == NULL || p->paths == NULL || p->positions == NULL || p->sorted == NULL) {
+        printf("ERROR: The memory for %d paths could not be allocated.\n", allocated);
+        mem_free(p->number_edges);
+        mem_free(p->paths);
+        mem_free(p->positions);
+        mem_free(p->sorted);
+        mem_free(p);
+        return NULL;
+    }
 
 	return p;
 }
 
+/**
+ * @brief Doubles the number of paths a structure holds
+ *
+ * @param p Structure whose arrays are grown, up to its limit of paths
+ *
+ * @details The arrays of a structure are only replaced when every one of
+ *          them could be grown, so on ERROR p is left as it was.
+ *
+ * @returns 0 if OK, -1 (ERROR) if the limit was reached or the memory could not be allocated
+ */
+int path_grow(Paths* p) {
+    int allocated = p->paths_allocated > p->paths_limit / 2 ? p->paths_limit : p->paths_allocated * 2;
+    int* number_edges = NULL;
+    STRING** paths = NULL;
+    int** positions = NULL;
+    int** sorted = NULL;
+
+    if ( p->paths_allocated >= p->paths_limit ) {
+		printf("ERROR: The limit (%d) of paths has been reached.\n", p->paths_limit);
+		return -1;
+	}
+
+    number_edges = (int*) mem_realloc( p->number_edges, sizeof(int) * allocated, MEM_PATHS );
+    if (number_edges != NULL) p->number_edges = number_edges;
+    paths = (STRING**) mem_realloc( p->paths, sizeof(STRING*) * allocated, MEM_PATHS );
+    if (paths != NULL) p->paths = paths;
+    positions = (int**) mem_realloc( p->positions, sizeof(int*) * allocated, MEM_PATHS );
+    if (positions != NULL) p->positions = positions;
+    sorted = (int**) mem_realloc( p->sorted, sizeof(int*) * allocated, MEM_PATHS );
+    if (sorted != NULL) p->sorted = sorted;
+
+    if (number_edges == NULL || paths == NULL || positions == NULL || sorted == NULL) {
+        printf("ERROR: The memory for %d paths could not be allocated.\n", allocated);
+        return -1;
+    }
+
+    memset(p->number_edges + p->paths_allocated, 0, sizeof(int) * (allocated - p->paths_allocated));
+    p->paths_allocated = allocated;
+    return 0;
+}
+
 /**
  * @brief Insert path
  *
  * @param p Structure that will store the path
  * @param path Path to be inserted
+ * @param positions Vertex position of each vertex of the path, see path_valid
  * @param size_path Number of vertices in the path
  *
  * @details Insert a path into the structure that stores the valid paths generated 
  *          by the permutation. The variable containing the position of the longest 
- *          stored path is also updated if the new path is the longest.
+ *          stored path is also updated if the new path is the longest. The indices
+ *          of its vertices are kept sorted by position for is_disjoint_path.
+ *          The arrays are grown by path_grow when they are full.
  * 
- * @returns IF the number of paths exceeds the maximum number, return -1 (ERROR)
+ * @returns IF the number of paths exceeds the maximum number, or the memory
+ *          could not be allocated, return -1 (ERROR)
  *          OTHERWISE, return 0 (INSERTION OK)
  */
 
-int path_add(Paths* p, STRING* path, int size_path) {
+int path_add(Paths* p, STRING* path, const int* positions, int size_path) {
     int	controller = -1;
     
-    if ( p->amount_paths >= p->paths_allocated ) {
-		printf("ERROR: The limit (%d) of paths has been reached.\n", p->paths_allocated);
+    if ( p->amount_paths >= p->paths_allocated && path_grow(p) != 0 ) {
 		return controller;
 	}
 
     // Allocate memory for an array of strings that will hold the entered path
     int	position = p->amount_paths;
-    p->paths[position] = (STRING*) malloc( sizeof(STRING) * size_path);
+    p->paths[position] = (STRING*) mem_malloc( sizeof(STRING) * size_path, MEM_PATHS);
 
     if (p->paths[position] != NULL) {
         for(int i = 0; i < size_path; i++) {
             // Allocate memory for vertex in path
-            p->paths[position][i] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
+            p->paths[position][i] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_PATHS );
             strcpy( p->paths[position][i], path[i]);
         }
 
+        // Positions of the vertices, and their indices sorted by position
+        p->positions[position] = (int*) mem_malloc( sizeof(int) * size_path, MEM_PATHS );
+        p->sorted[position] = (int*) mem_malloc( sizeof(int) * size_path, MEM_PATHS );
+        memcpy(p->positions[position], positions, sizeof(int) * size_path);
+        for (int i = 0; i < size_path; i++) {
+            int j = i;
+
+            for ( ; j > 0 && positions[p->sorted[position][j - 1]] > positions[i]; j--) {
+                p->sorted[position][j] = p->sorted[position][j - 1];
+            }
+            p->sorted[position][j] = i;
+        }
+
         // Number of edges in the inserted path
         p->number_edges[position] = size_path - 1;
 
@@ -115,28 +196,36 @@ void print_paths(Paths* p) {
  *
  * @param graph Graph to be iterated
  *
- * @details Calculates the number of all paths between two vertices
+ * @details Calculates the number of all paths between two vertices. The count
+ *          grows as a factorial of the vertices, past a dozen of them it does
+ *          not fit in an int and INT_MAX is returned instead.
  * 
- * @returns Number of all paths between two vertices
+ * @returns Number of all paths between two vertices, at most INT_MAX
  */
 int calculate_number_of_possible_paths(Graph* graph) {
-    int amount_paths = 1;   /* Starts with 1 considering a direct edge between source vertex and destination vertex */
+    long amount_paths = 1;   /* Starts with 1 considering a direct edge between source vertex and destination vertex */
     int number_vertices_between = 1; /* Number of vertices between source and destination */
-    int result_amount_vertices_between = 1; /* Partial result of the number of permutations with a specific number of vertices between source and destination */
+    long result_amount_vertices_between = 1; /* Partial result of the number of permutations with a specific number of vertices between source and destination */
     int number_permuted_vertices = graph->vertices_allocated - 2; /* As origin and destination are fixed, the number of different paths generated is related to the number of vertices that can be interchanged */
 
     while (number_vertices_between <= number_permuted_vertices) {
         /* Calculate the number of different paths with a given number of vertices */
         for (int i = 0; i < number_vertices_between; i++) {
             result_amount_vertices_between = result_amount_vertices_between * (number_permuted_vertices - i);
+            if (result_amount_vertices_between > INT_MAX) {
+                return INT_MAX;
+            }
         }
         /* Add the previous result to the calculated number of permutations and restart variables to calculate a new permutation */
         amount_paths += result_amount_vertices_between;
+        if (amount_paths > INT_MAX) {
+            return INT_MAX;
+        }
         number_vertices_between++;
         result_amount_vertices_between = 1;
     }
 
-    return amount_paths;
+    return (int) amount_paths;
 }
 
 /**
@@ -148,7 +237,12 @@ int calculate_number_of_possible_paths(Graph* graph) {
  * @details Swap vertices to be able to swap through path variations
  */
 void swap(STRING first_vertice, STRING second_vertice) {
-    STRING temp = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
+    char temp[STR_SIZE + 1];
+
+    // A vertex swapped with itself stays, strcpy must not copy a string onto itself
+    if (first_vertice == second_vertice) {
+        return;
+    }
     strcpy(temp, first_vertice);
     strcpy(first_vertice, second_vertice);
     strcpy(second_vertice, temp);
@@ -157,16 +251,18 @@ void swap(STRING first_vertice, STRING second_vertice) {
 /**
  * @brief Validate if generated permuted path is valid
  *
- * @param graph Graph that contains the real paths
+ * @param view View of the graph that contains the real paths
  * @param path Path to be validated
  * @param size_path Size of the path that will be validated
+ * @param positions Receives the vertex position of each vertex of the path
  *
  * @details Check if each edge in the path exists in the graph, if all 
- *          edges exist the path is valid, otherwise it is invalid
+ *          edges exist the path is valid, otherwise it is invalid. Edges
+ *          are looked up by position, see graph_has_edge
  * 
  * @return Return 1 if path is valid, otherwise 0
  */
-int path_valid(STRING* path, Graph* graph, int size_path) {
+int path_valid(STRING* path, Overlay* view, int size_path, int* positions) {
     int controll = 0,
         i = 0,
         first_vertice = -1,
@@ -174,13 +270,15 @@ int path_valid(STRING* path, Graph* graph, int size_path) {
 
     // Check if each edge in the path exists in the graph, if any do not exist then the path is not valid
     for (i = 0; i < (size_path -1); i++) {
-        first_vertice = graph_vertice_finder(graph, path[i]);
+        first_vertice = i == 0 ? graph_vertice_finder(view->base, path[i]) : second_vertice;
+        second_vertice = graph_vertice_finder(view->base, path[i + 1]);
+        positions[i] = first_vertice;
+        positions[i + 1] = second_vertice;
 
         // Check if vertex exists
-        if (first_vertice != -1) {
+        if (first_vertice != -1 && second_vertice != -1) {
             // Check if path exists from current vertex to next vertex in path
-            second_vertice = graph_edge_finder(graph, first_vertice, path[i + 1]);
-            if (second_vertice == -1) {
+            if (! overlay_has_edge(view, first_vertice, second_vertice)) {
                 i = size_path;
             }
         } else {
@@ -199,7 +297,7 @@ int path_valid(STRING* path, Graph* graph, int size_path) {
 /**
  * @brief Permut paths with a specified number of vertices between source and destination vertices
  *
- * @param graph Graph that contains the real paths
+ * @param view View of the graph that contains the real paths
  * @param sequence Sequence of vertices that do not contain the source and destination vertex
  * @param paths Structure that stores the permuted valid paths
  * @param vertex_origin First vertex of the path, is the origin vertex
@@ -210,19 +308,17 @@ int path_valid(STRING* path, Graph* graph, int size_path) {
  *
  * @details Permut the paths, parses which ones are valid, and stores the valid ones in the structure
  */
-void permute(Graph* graph, STRING* sequence, Paths* paths, STRING vertex_origin, STRING destination_vertex, int size_sequence, int number_vertices_between, int index) {
+void permute(Overlay* view, STRING* sequence, Paths* paths, STRING vertex_origin, STRING destination_vertex, int size_sequence, int number_vertices_between, int index) {
     
     if (index == number_vertices_between) {
         // Reserve space in memory for a swapped path
-        STRING* path = (STRING*) malloc( sizeof(STRING) * number_vertices_between + 3);
+        STRING* path = (STRING*) mem_malloc( sizeof(STRING) * ( number_vertices_between + 2 ), MEM_PATHS );
+        int* positions = (int*) mem_malloc( sizeof(int) * ( number_vertices_between + 2 ), MEM_PATHS );
         int pos = 0;
 
-        // Reserve space for source vertex and insert it into path
-        path[0] = (STRING) malloc( sizeof(char) * (STR_SIZE + 1) );
-        
         // Reserve space for vertices that are between source and destination and insert them into the path
         for (int i = 0; i < (number_vertices_between + 2); i++) {
-            path[i] = (STRING) malloc( sizeof(char) * (STR_SIZE + 1) );
+            path[i] = (STRING) mem_malloc( sizeof(char) * (STR_SIZE + 1), MEM_PATHS );
             if (i == 0) {
                 strcpy(path[i], "");
                 strcpy(path[i], vertex_origin);
@@ -237,25 +333,26 @@ void permute(Graph* graph, STRING* sequence, Paths* paths, STRING vertex_origin,
         }
 
         // If valid path it is added in structure
-        if (path_valid(path, graph, number_vertices_between + 2) == VALID) {
-            path_add(paths, path, number_vertices_between + 2);
+        if (path_valid(path, view, number_vertices_between + 2, positions) == VALID) {
+            path_add(paths, path, positions, number_vertices_between + 2);
         }        
+        mem_free(positions);
 
         // Free up swapped path memory as a new one will be generated
         if (path != NULL) {
             for (int i = 0; i < (number_vertices_between + 2); i++) {
                 if (path[i] != NULL) {
-                    free(path[i]);
+                    mem_free(path[i]);
                 }
             }
-            free(path);
+            mem_free(path);
         }
         return;
     }
 
     for (int i = index; i < size_sequence; i++) {
         swap(sequence[i], sequence[index]);
-        permute(graph, sequence, paths, vertex_origin, destination_vertex, size_sequence, number_vertices_between, index + 1);
+        permute(view, sequence, paths, vertex_origin, destination_vertex, size_sequence, number_vertices_between, index + 1);
         swap(sequence[i], sequence[index]);
     }
 }
@@ -263,17 +360,20 @@ void permute(Graph* graph, STRING* sequence, Paths* paths, STRING vertex_origin,
 /**
  * @brief Permut paths with all possible combinations according to a fixed source and destination vertex
  *
- * @param graph Graph that contains the real paths
+ * @param view View of the graph that contains the real paths
  * @param paths Structure that stores the permuted valid paths
  * @param vertex_origin First vertex of the path, is the origin vertex
  * @param destination_vertex Last vertex of the path is the destination vertex
+ * @param between Vertices that can be between origin and destination, see permutation_between, NULL for every vertex
  * 
  * @details Permut paths with all possible combinations, from no vertex from source 
- *          to destination, to all vertices in the path
+ *          to destination, to all vertices in the path. Only the vertices of
+ *          between are permuted, as no valid path goes through any other one.
  */
-void permuted_paths (Graph* graph, Paths* paths, STRING vertex_origin, STRING destination_vertex) {
+void permuted_paths (Overlay* view, Paths* paths, STRING vertex_origin, STRING destination_vertex, const WORD* between) {
+    Graph* graph = view->base;
     int size_sequence = graph->vertices_amount - 2;
-    STRING* sequence = (STRING*) malloc( sizeof(STRING) * size_sequence);
+    STRING* sequence = (STRING*) mem_malloc( sizeof(STRING) * size_sequence, MEM_PATHS);
     int position_origin = graph_vertice_finder(graph, vertex_origin);
     int position_destination = graph_vertice_finder(graph, destination_vertex);
     int position_sequence = 0;
@@ -281,19 +381,26 @@ void permuted_paths (Graph* graph, Paths* paths, STRING vertex_origin, STRING de
     
     // Form vector without origin and destination vertices
     for (int i = 0; i < graph->vertices_amount; i++) {
+        if (between != NULL && ! (between[i / WORD_BITS] & ((WORD) 1 << (i % WORD_BITS)))) continue;
 
         if (i != position_origin && i != position_destination) {
-            sequence[position_sequence] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
+            sequence[position_sequence] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_PATHS );
             strcpy(sequence[position_sequence], graph->vertices[i]);
             position_sequence++;
         }
     }
+    size_sequence = position_sequence;
     
     // Permuted paths with vertices between origin and destination, from 0 to the number of vertices in the sequence between origin and destination
     while(number_vertices_between <= size_sequence) {
-        permute(graph, sequence, paths, vertex_origin, destination_vertex, size_sequence, number_vertices_between, 0);
+        permute(view, sequence, paths, vertex_origin, destination_vertex, size_sequence, number_vertices_between, 0);
         number_vertices_between++;
     }
+
+    for (int i = 0; i < size_sequence; i++) {
+        mem_free(sequence[i]);
+    }
+    mem_free(sequence);
 }
 
 /**
@@ -315,10 +422,13 @@ void free_paths(Paths* paths) {
             for (int j = 0; j < number_vertices; j++) {
                 // Freeing memory from each vertex of the path
                 if (paths->paths[i][j] != NULL) {
-                    free(paths->paths[i][j]);
+                    mem_free(paths->paths[i][j]);
                 }
             }
         }
+        mem_free(paths->paths[i]);
+        mem_free(paths->positions[i]);
+        mem_free(paths->sorted[i]);
     }
 
     // Reset path control variables
@@ -330,6 +440,20 @@ void free_paths(Paths* paths) {
     }
 }
 
+/**
+ * @brief Frees a structure of paths, see path_initializer
+ *
+ * @param paths Structure that will be freed, with the paths it still stores
+ */
+void path_destroy(Paths* paths) {
+    free_paths(paths);
+    mem_free(paths->number_edges);
+    mem_free(paths->paths);
+    mem_free(paths->positions);
+    mem_free(paths->sorted);
+    mem_free(paths);
+}
+
 /**
  * @brief Checks if the paths are disjoint
  *
@@ -338,50 +462,67 @@ void free_paths(Paths* paths) {
  *                               compared with the longest path
  *
  * @details If all edges of the shortest path are different from the longest 
- *          path, then the paths are disjoint.
+ *          path, then the paths are disjoint. Paths are simple, so a sorted
+ *          merge of their vertex positions finds the common vertices in
+ *          O(k) instead of comparing every pair of names.
  * 
  * @return Returns 1 if the paths are disjoint, otherwise 0
  */
 int is_disjoint_path(Paths* paths, int shortest_path_position) {
     int controll = 1,
-        first_vertice = -1;
-    int number_edges_less = paths->number_edges[shortest_path_position];
-    int number_edges_bigger = paths->number_edges[paths->position_greatest_path];
-
-    for (int i = 0; i < number_edges_less; i++) {
-        first_vertice = -1;
-        for (int j = 0; j < number_edges_bigger; j++) {
-            // If first vertex equals
-            if (strcmp(paths->paths[shortest_path_position][i], paths->paths[paths->position_greatest_path][j]) == 0) {
-                first_vertice = j;
-                j = number_edges_bigger;
+        i = 0,
+        j = 0;
+    int greatest = paths->position_greatest_path;
+    int number_vertices_less = paths->number_edges[shortest_path_position] + 1;
+    int number_vertices_bigger = paths->number_edges[greatest] + 1;
+    int* less = paths->positions[shortest_path_position];
+    int* bigger = paths->positions[greatest];
+    int* less_sorted = paths->sorted[shortest_path_position];
+    int* bigger_sorted = paths->sorted[greatest];
+    int* where = (int*) mem_malloc( sizeof(int) * number_vertices_less, MEM_PATHS );
+
+    for (i = 0; i < number_vertices_less; i++) {
+        where[i] = -1;
+    }
+
+    // Merging both paths by vertex position gives where each vertex of the shortest path is in the longest
+    i = 0;
+    while (i < number_vertices_less && j < number_vertices_bigger) {
+        if (less[less_sorted[i]] == bigger[bigger_sorted[j]]) {
+            // The destination closes every path, it is not compared
+            if (bigger_sorted[j] < number_vertices_bigger - 1) {
+                where[less_sorted[i]] = bigger_sorted[j];
             }
+            i++;
+            j++;
+        } else if (less[less_sorted[i]] < bigger[bigger_sorted[j]]) {
+            i++;
+        } else {
+            j++;
         }
+    }
 
-        if (first_vertice != -1) {
-            for (int j = first_vertice + 1; j < number_edges_bigger; j++) {
-                // If second vertex equals
-                if (strcmp(paths->paths[shortest_path_position][i + 1], paths->paths[paths->position_greatest_path][j]) == 0) {
-                    j = number_edges_bigger;
-                    controll = 0;
-                    i = number_edges_less;
-                }
-            }
+    // An edge whose first vertex comes before the second one in the longest path is shared with it
+    for (i = 0; i < (number_vertices_less - 1); i++) {
+        if (where[i] != -1 && where[i + 1] > where[i]) {
+            controll = 0;
+            break;
         }
     }
 
+    mem_free(where);
     return controll;
 }
 
 /**
  * @brief Remove minor paths that are disjoint from the longest path between two vertices
  *
- * @param graph Graph that will have the paths removed
+ * @param view View of the graph that will have the paths removed
  * @param paths Structure that has the paths that will be compared if they are disjoint
  * 
  * @details If paths are disjoint then minor can be removed
  */
-void delete_path_disjoint(Graph* graph, Paths* paths) {
+void delete_path_disjoint(Overlay* view, Paths* paths) {
     int i = 0,
         number_edges = 0,
         first_vertice = -1,
@@ -398,28 +539,13 @@ void delete_path_disjoint(Graph* graph, Paths* paths) {
                 number_edges = paths->number_edges[i];
                 for (int j = 0; j < number_edges; j++) {
                     
-                    first_vertice = graph_vertice_finder(graph, paths->paths[i][j]);
-                    if (first_vertice != -1) {
-
-                        second_vertice = graph_edge_finder(graph, first_vertice, paths->paths[i][j + 1]);
-
-                        if (second_vertice != - 1) {
-                            free_edge(graph, first_vertice, second_vertice);
-                            graph->edges_amount -= 1;
-                            
-                            
-                            // Remove the edge as if it were the opposite path, as it is an undirected graph
-                            if (graph->flag == NON_DIRECTED) {
-                                first_vertice = graph_vertice_finder(graph, paths->paths[i][j + 1]);
-
-                                if (first_vertice != -1) {
-                                    second_vertice = graph_edge_finder(graph, first_vertice, paths->paths[i][j]);
-                                    if (second_vertice != -1) {
-                                        free_edge(graph, first_vertice, second_vertice);
-                                    }
-                                }
-                            }
-                        }
+                    first_vertice = paths->positions[i][j];
+                    second_vertice = paths->positions[i][j + 1];
+
+                    // On an undirected graph the view also removes the opposite direction
+                    if (first_vertice != -1 && second_vertice != -1 && overlay_has_edge(view, first_vertice, second_vertice)) {
+                        overlay_delete_edge(view, first_vertice, second_vertice);
+                        checkpoint_removed(view->checkpoint, first_vertice, second_vertice);
                     }
                 }
             }
@@ -427,6 +553,88 @@ void delete_path_disjoint(Graph* graph, Paths* paths) {
     }
 }
 
+/**
+ * @brief Reduces the paths from one vertex to another
+ *
+ * @param view View of the graph that will have the paths removed
+ * @param paths Structure that stores the permuted valid paths, emptied at the end
+ * @param origin Position of the first vertex of the paths
+ * @param destination Position of the last vertex of the paths
+ * @param between Vertices permuted between them, see permuted_paths
+ */
+void permutation_pair(Overlay* view, Paths* paths, int origin, int destination, const WORD* between) {
+    Graph* graph = view->base;
+
+    permuted_paths(view, paths, graph->vertices[origin], graph->vertices[destination], between);
+    //print_paths(paths);
+
+    // Remove minor paths that are disjoint from the longest path if there is more than one valid permuted path
+    if (paths->amount_paths > 1) {
+        delete_path_disjoint(view, paths);
+    }
+
+    /*  Free up memory of the generated paths, as new permutations will be generated in the 
+        structure for other source and destination vertices 
+    */
+    free_paths(paths);
+}
+
+/**
+ * @brief Descendants of a vertex, as permutation() walks its pairs
+ *
+ * @param graph Graph to be iterated
+ * @param descendants Descendant rows of bitmatrix_reachability, NULL to ask graph_closure_contains
+ * @param vertex Vertex whose descendants are wanted
+ * @param row Receives the descendants, a bit per vertex
+ * @param words Number of WORDs of row
+ *
+ * @details Without the rows, under CLOSURE_LAZY, the lazy closure answers
+ *          and keeps its memory bound.
+ */
+void permutation_descendants(Graph* graph, BitMatrix* descendants, int vertex, WORD* row, int words) {
+    if (descendants != NULL) {
+        memcpy(row, bitmatrix_row(descendants, vertex), sizeof(WORD) * words);
+        return;
+    }
+
+    memset(row, 0, sizeof(WORD) * words);
+    for (int j = 0; j < graph->vertices_amount; j++) {
+        if (graph_closure_contains(graph, vertex, j)) {
+            row[j / WORD_BITS] |= (WORD) 1 << (j % WORD_BITS);
+        }
+    }
+}
+
+/**
+ * @brief Vertices that can be on a path from one vertex to another
+ *
+ * @param graph Graph to be iterated
+ * @param descendants Descendant rows of bitmatrix_reachability, NULL to ask graph_closure_contains
+ * @param ancestors Ancestor rows of bitmatrix_reachability, NULL to ask graph_closure_contains
+ * @param origin Position of the first vertex of the paths
+ * @param destination Position of the last vertex of the paths
+ * @param row Receives the descendants of origin that are ancestors of destination
+ * @param words Number of WORDs of row
+ */
+void permutation_between(Graph* graph, BitMatrix* descendants, BitMatrix* ancestors, int origin, int destination, WORD* row, int words) {
+    if (descendants != NULL) {
+        WORD* down = bitmatrix_row(descendants, origin);
+        WORD* up = bitmatrix_row(ancestors, destination);
+
+        for (int w = 0; w < words; w++) {
+            row[w] = down[w] & up[w];
+        }
+        return;
+    }
+
+    memset(row, 0, sizeof(WORD) * words);
+    for (int v = 0; v < graph->vertices_amount; v++) {
+        if (graph_closure_contains(graph, origin, v) && graph_closure_contains(graph, v, destination)) {
+            row[v / WORD_BITS] |= (WORD) 1 << (v % WORD_BITS);
+        }
+    }
+}
+
 /**
  * @brief Transitive reduction through the permutation method
  *
@@ -437,58 +645,135 @@ void delete_path_disjoint(Graph* graph, Paths* paths) {
  *          between two vertices of the original graph, the valid paths are 
  *          filtered. Among the valid ones, the one with the greatest number 
  *          of edges is chosen between two vertices and the others that are 
- *          disjoint from this path are excluded.
+ *          disjoint from this path are excluded. With a checkpoint_path,
+ *          the work is journaled there and resumed by a later run on the
+ *          same input. On a directed acyclic graph, the descendant and
+ *          ancestor rows of bitmatrix_reachability, or the lazy closure
+ *          under CLOSURE_LAZY, give the pairs connected each way: the
+ *          forward pairs are the descendants of i above it, the transposed
+ *          ones the descendants below it, so both passes only visit
+ *          connected pairs, each once, and permute the vertices that can be
+ *          between them. The passes keep their order, on which the edges
+ *          removed depend, and the checkpoint steps of every pair.
  * 
- * @returns Transitive reduction of graph
+ * @returns Transitive reduction of graph, NULL if the checkpoint can not be used
  */
 Graph* permutation(Graph* graph) {
-    Graph* clone_graph;
-    clone_graph = graph_clone(graph);
+    Overlay* view = overlay_initializer(graph);
+    Graph* reduced = NULL;
+    BitMatrix* descendants = NULL;
+    BitMatrix* ancestors = NULL;
+    long step = 0;      /* Pairs of vertices handled, the cursor of the checkpoint */
+    long resume = 0;
+    long n = graph->vertices_amount;
+    long forward = n * (n - 1) / 2;     /* Steps of the first pass */
+
+    // Pairs handled before the last commit are skipped, their removals are replayed
+    if (checkpoint_path != NULL) {
+        view->checkpoint = checkpoint_open(checkpoint_path, CHECKPOINT_PERMUTATION, graph);
+        if (view->checkpoint == NULL) {
+            overlay_destroy(view);
+            return NULL;
+        }
+        checkpoint_restore(view->checkpoint, view);
+        resume = checkpoint_resume(view->checkpoint);
+    }
 
     int amount_paths = calculate_number_of_possible_paths(graph);      /* Number of all permuted paths in a graph */
     Paths* paths = path_initializer(amount_paths);
+    if (paths == NULL) {
+        checkpoint_close(view->checkpoint, 0);
+        overlay_destroy(view);
+        return NULL;
+    }
+    int pruned = graph->flag == DIRECTED && ! isCyclic(graph);
+
+    if (! pruned) {
+        for( int i = 0; i < (graph->vertices_amount - 1); i++ ){
+            for (int j = i + 1; j < graph->vertices_amount; j++) {
+                if (++step <= resume) continue;
+                //printf("Caminhos gerados: %s - %s\n", graph->vertices[i], graph->vertices[j]);
+
+                permutation_pair(view, paths, i, j, NULL);
+                checkpoint_cursor(view->checkpoint, step);
+            }
+        }
+
+        // Permut the transpose graph
+        if (graph->flag == DIRECTED) {
 
-    for( int i = 0; i < (graph->vertices_amount - 1); i++ ){
-        for (int j = i + 1; j < graph->vertices_amount; j++) {
-            //printf("Caminhos gerados: %s - %s\n", clone_graph->vertices[i], clone_graph->vertices[j]);
+            for( int i = graph->vertices_amount - 1; i > 0; i-- ){
+                for (int j = i - 1; j >= 0; j--) {
+                    if (++step <= resume) continue;
 
-            permuted_paths(clone_graph, paths, clone_graph->vertices[i], clone_graph->vertices[j]);
-            //print_paths(paths);
-            
-            // Remove minor paths that are disjoint from the longest path if there is more than one valid permuted path
-            if (paths->amount_paths > 1) {
-                delete_path_disjoint(clone_graph, paths);
+                    permutation_pair(view, paths, i, j, NULL);
+                    checkpoint_cursor(view->checkpoint, step);
+                }
             }
+        }
+    } else {
+        int words = (int) ((n + WORD_BITS - 1) / WORD_BITS);
+        WORD* row = (WORD*) mem_malloc( sizeof(WORD) * (words + 1), MEM_PATHS );
+        WORD* between = (WORD*) mem_malloc( sizeof(WORD) * (words + 1), MEM_PATHS );
 
-            /*  Free up memory of the generated paths, as new permutations will be generated in the 
-                structure for other source and destination vertices 
-            */
-            free_paths(paths);
+        if (graph->closure_storage != CLOSURE_LAZY) {
+            bitmatrix_reachability(graph, &descendants, &ancestors);
         }
-	}
 
-    // Permut the transpose graph
-    if (graph->flag == DIRECTED) {
+        // Pairs (i, j), j > i, reachable from i, in the order of the loops over every pair
+        for (int i = 0; i < n - 1; i++) {
+            permutation_descendants(graph, descendants, i, row, words);
 
-        for( int i = graph->vertices_amount - 1; i > 0; i-- ){
-            for (int j = i - 1; j >= 0; j--) {
-                //printf("Caminhos gerados: %s - %s\n", clone_graph->vertices[i], clone_graph->vertices[j]);
+            for (int w = (i + 1) / WORD_BITS; w < words; w++) {
+                WORD bits = row[w];
 
-                permuted_paths(clone_graph, paths, clone_graph->vertices[i], clone_graph->vertices[j]);
-                //print_paths(paths);
-                
-                // Remove minor paths that are disjoint from the longest path if there is more than one valid permuted path
-                if (paths->amount_paths > 1) {
-                    delete_path_disjoint(clone_graph, paths);
+                if (w == (i + 1) / WORD_BITS) bits &= ~(WORD) 0 << ((i + 1) % WORD_BITS);
+                while (bits != 0) {
+                    int j = w * WORD_BITS + __builtin_ctzll(bits);
+
+                    bits &= bits - 1;
+                    step = i * (n - 1) - (long) i * (i - 1) / 2 + (j - i);
+                    if (step <= resume) continue;
+
+                    permutation_between(graph, descendants, ancestors, i, j, between, words);
+                    permutation_pair(view, paths, i, j, between);
+                    checkpoint_cursor(view->checkpoint, step);
                 }
+            }
+        }
+
+        // Permut the transpose graph: pairs (i, j), j < i, reachable from i, i and j going down
+        for (int i = n - 1; i > 0; i--) {
+            permutation_descendants(graph, descendants, i, row, words);
+
+            for (int w = (i - 1) / WORD_BITS; w >= 0; w--) {
+                WORD bits = row[w];
 
-                /*  Free up memory of the generated paths, as new permutations will be generated in the 
-                    structure for other source and destination vertices 
-                */
-                free_paths(paths);
+                if (w == (i - 1) / WORD_BITS && (i % WORD_BITS) != 0) bits &= ~(~(WORD) 0 << (i % WORD_BITS));
+                while (bits != 0) {
+                    int j = w * WORD_BITS + WORD_BITS - 1 - __builtin_clzll(bits);
+
+                    bits &= ~((WORD) 1 << (j % WORD_BITS));
+                    step = forward + forward - (long) i * (i + 1) / 2 + (i - j);
+                    if (step <= resume) continue;
+
+                    permutation_between(graph, descendants, ancestors, i, j, between, words);
+                    permutation_pair(view, paths, i, j, between);
+                    checkpoint_cursor(view->checkpoint, step);
+                }
             }
         }
+
+        bitmatrix_destroy(descendants);
+        bitmatrix_destroy(ancestors);
+        mem_free(row);
+        mem_free(between);
     }
 
-    return clone_graph;
-}
\ No newline at end of file
+    path_destroy(paths);
+    checkpoint_close(view->checkpoint, 1);
+    reduced = overlay_materialise(view);
+    overlay_destroy(view);
+
+    return reduced;
+}
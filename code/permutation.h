@@ -18,8 +18,12 @@
     #define INVALID		    0		      /* Information if permuted path is invalid */
     #define VALID         1         /* Information if permuted path is valid   */
     #define IS_DISJOINT   1         /* Information if the paths are disjoint */
+    #define PATHS_INITIAL 64        /* Paths the arrays hold at first, they double when full */
   /**@}*/
 
+  struct Overlay;                 /* Copy-on-write view of a graph, see overlay.h */
+  struct BitMatrix;               /* Rows of bits, see bitset.h */
+
   typedef struct Paths {
 
     /**
@@ -27,10 +31,13 @@
      */
     /**@{*/
     int amount_paths;             /* Number of inserted permuted paths */
-    int paths_allocated;          /* Maximum number of permuted paths */
+    int paths_allocated;          /* Number of paths the arrays hold at the moment */
+    int paths_limit;              /* Maximum number of permuted paths */
     int position_greatest_path;   /* Position of the greatest path */
     int* number_edges;				    /* Number of edges in each valid permuted path */
     STRING** paths;			          /* Vector containing the permuted valid paths */
+    int** positions;              /* Vertex position of each vertex of the paths, parallel to paths */
+    int** sorted;                 /* Indices of the vertices of each path, sorted by vertex position */
     /**@}*/      
   } Paths;
 	
@@ -44,15 +51,20 @@
  */
 /**@{*/
 extern Paths* path_initializer(int number_of_paths);
-extern int path_add(Paths* p, STRING* path, int size_path);
+extern int path_grow(Paths* p);
+extern int path_add(Paths* p, STRING* path, const int* positions, int size_path);
 extern void print_paths(Paths* p);
 extern int calculate_number_of_possible_paths(Graph* graph);
 extern void swap(STRING first_vertice, STRING second_vertice);
-extern int path_valid(STRING* path, Graph* graph, int size_path);
-extern void permute(Graph* graph, STRING* sequence, Paths* paths, STRING vertex_origin, STRING destination_vertex, int size_sequence, int number_vertices_between, int index);
-extern void permuted_paths (Graph* graph, Paths* paths, STRING vertex_origin, STRING destination_vertex);
+extern int path_valid(STRING* path, struct Overlay* view, int size_path, int* positions);
+extern void permute(struct Overlay* view, STRING* sequence, Paths* paths, STRING vertex_origin, STRING destination_vertex, int size_sequence, int number_vertices_between, int index);
+extern void permuted_paths (struct Overlay* view, Paths* paths, STRING vertex_origin, STRING destination_vertex, const WORD* between);
 extern void free_paths(Paths* paths);
-extern void delete_path_disjoint(Graph* graph, Paths* paths);
+extern void path_destroy(Paths* paths);
+extern void delete_path_disjoint(struct Overlay* view, Paths* paths);
 extern int is_disjoint_path(Paths* paths, int shortest_path_position);
+extern void permutation_pair(struct Overlay* view, Paths* paths, int origin, int destination, const WORD* between);
+extern void permutation_descendants(Graph* graph, struct BitMatrix* descendants, int vertex, WORD* row, int words);
+extern void permutation_between(Graph* graph, struct BitMatrix* descendants, struct BitMatrix* ancestors, int origin, int destination, WORD* row, int words);
 extern Graph* permutation(Graph* graph);
 /**@}*/
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "graph.h"
+#include "quotient.h"
+#include "memtrack.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+int quotient_enabled = 0;
+
+#define FNV_OFFSET	14695981039346656037UL
+#define FNV_PRIME	1099511628211UL
+
+/**
+ * @brief Adds a list of positions to a FNV-1a hash
+ */
+uint64_t quotient_hash_list(uint64_t hash, const int* list, int amount) {
+	const unsigned char	*bytes = (const unsigned char*) list;
+
+	// The length keeps a list and its continuation apart
+	for ( size_t i = 0; i < sizeof(int); i++ ) {
+		hash ^= ( (const unsigned char*) &amount )[i];
+		hash *= FNV_PRIME;
+	}
+	for ( size_t i = 0; i < sizeof(int) * amount; i++ ) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+/**
+ * @brief Checks if two lists of positions are equal
+ *
+ * @returns 1 if equal, otherwise 0
+ */
+int quotient_same_list(const int* first, int first_amount, const int* second, int second_amount) {
+	return first_amount == second_amount && memcmp(first, second, sizeof(int) * first_amount) == 0;
+}
+
+/**
+ * @brief Groups the vertices of a directed acyclic graph with the same neighbourhood
+ *
+ * @param graph Graph to be iterated
+ *
+ * @details Two vertices are equivalent when they have the same predecessors and
+ *          the same neighbours. Lists of neighbours are sorted, and lists of
+ *          predecessors come out sorted from one counting pass over the edges,
+ *          so each vertex is hashed from both lists and looked up in an
+ *          open-addressing table of classes; a hit is confirmed by comparing
+ *          the lists themselves. Equivalent vertices of an acyclic graph never
+ *          reach one another, and every edge between two classes exists for
+ *          all their members, so a vertex reaches another exactly when its
+ *          class reaches the other's in the quotient graph. The reduction of
+ *          the graph is then the reduction of the quotient graph, expanded.
+ *          That does not hold on cycles nor on non-directed graphs.
+ *
+ * @returns Reference to newly create Quotient, NULL if graph is not a directed
+ *          acyclic graph or no two vertices are equivalent
+ */
+Quotient* quotient_compute(Graph* graph) {
+	int		n = graph->vertices_amount,
+			size = 1,
+			classes = 0;
+	int		*offsets = NULL,
+			*predecessors = NULL,
+			*table = NULL,
+			*class = NULL,
+			*representative = NULL;
+	uint64_t	*hash = NULL;
+	Quotient	*quotient = NULL;
+
+	if ( graph->flag != DIRECTED || isCyclic(graph) ) {
+		printf("WARNING: Equivalent vertices are only merged on directed acyclic graphs\n");
+		return NULL;
+	}
+
+	// Predecessors of every vertex, grouped by vertex and sorted as they are met
+	offsets = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+	predecessors = (int*) mem_malloc( sizeof(int) * graph->edges_amount + 1, MEM_SCRATCH );
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) offsets[graph->edges_index[u][k] + 1]++;
+	}
+	for ( int v = 0; v < n; v++ ) offsets[v + 1] += offsets[v];
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) predecessors[offsets[graph->edges_index[u][k]]++] = u;
+	}
+	for ( int v = n; v > 0; v-- ) offsets[v] = offsets[v - 1];
+	offsets[0] = 0;
+
+	while ( size < 2 * n ) size <<= 1;
+	table = (int*) mem_malloc( sizeof(int) * size, MEM_SCRATCH );
+	hash = (uint64_t*) mem_malloc( sizeof(uint64_t) * n + 1, MEM_SCRATCH );
+	class = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+	representative = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+	for ( int s = 0; s < size; s++ ) table[s] = -1;
+
+	for ( int v = 0; v < n; v++ ) {
+		int	slot = 0;
+
+		hash[v] = quotient_hash_list(FNV_OFFSET, graph->edges_index[v], graph->edges_neighbours[v]);
+		hash[v] = quotient_hash_list(hash[v], predecessors + offsets[v], offsets[v + 1] - offsets[v]);
+
+		for ( slot = hash[v] & ( size - 1 ); table[slot] != -1; slot = ( slot + 1 ) & ( size - 1 ) ) {
+			int	r = representative[table[slot]];
+
+			if ( hash[r] == hash[v]
+			     && quotient_same_list(graph->edges_index[r], graph->edges_neighbours[r], graph->edges_index[v], graph->edges_neighbours[v])
+			     && quotient_same_list(predecessors + offsets[r], offsets[r + 1] - offsets[r], predecessors + offsets[v], offsets[v + 1] - offsets[v]) ) {
+				break;
+			}
+		}
+
+		if ( table[slot] == -1 ) {
+			table[slot] = classes;
+			representative[classes++] = v;
+		}
+		class[v] = table[slot];
+	}
+
+	mem_free(offsets);
+	mem_free(predecessors);
+	mem_free(table);
+	mem_free(hash);
+
+	if ( classes == n ) {
+		mem_free(class);
+		mem_free(representative);
+		return NULL;
+	}
+
+	quotient = (Quotient*) mem_malloc( sizeof(Quotient), MEM_SCRATCH );
+	quotient->vertices = n;
+	quotient->classes = classes;
+	quotient->class = class;
+	quotient->representative = representative;
+	return quotient;
+}
+
+/**
+ * @brief Quotient graph, one vertex per class
+ *
+ * @param graph Graph given to quotient_compute
+ * @param quotient Classes of graph
+ *
+ * @details Classes keep the order of their first vertex and take its name. The
+ *          neighbours of a class are the classes of the neighbours of its
+ *          representative, each inserted once.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* quotient_apply(Graph* graph, Quotient* quotient) {
+	int	classes = quotient->classes,
+		edges = 0;
+	int	*mark = (int*) mem_calloc( classes + 1, sizeof(int), MEM_SCRATCH ),
+		*sources = (int*) mem_malloc( sizeof(int) * graph->edges_amount + 1, MEM_SCRATCH ),
+		*destinations = (int*) mem_malloc( sizeof(int) * graph->edges_amount + 1, MEM_SCRATCH );
+	Graph	*g = NULL;
+
+	for ( int c = 0; c < classes; c++ ) {
+		int	r = quotient->representative[c];
+
+		for ( int k = 0; k < graph->edges_neighbours[r]; k++ ) {
+			int	d = quotient->class[graph->edges_index[r][k]];
+
+			if ( mark[d] == c + 1 ) continue;
+
+			mark[d] = c + 1;
+			sources[edges] = c;
+			destinations[edges] = d;
+			edges++;
+		}
+	}
+
+	if ( ( g = graph_initializer(classes, edges > 0 ? edges : 1, graph->flag) ) != NULL ) {
+		g->closure_storage = graph->closure_storage;
+		for ( int c = 0; c < classes; c++ ) graph_add_vertice(g, graph->vertices[quotient->representative[c]]);
+		graph_add_edges(g, sources, destinations, edges);
+	}
+
+	mem_free(mark);
+	mem_free(sources);
+	mem_free(destinations);
+	return g;
+}
+
+/**
+ * @brief Brings the reduction of a quotient graph back to the whole graph
+ *
+ * @param reduced Reduction of the output of quotient_apply, with its vertices in the same positions
+ * @param original Graph given to quotient_compute
+ * @param quotient Classes of original
+ *
+ * @details An edge of original is kept exactly when the edge between the
+ *          classes of its ends is kept, and lists of neighbours keep the order
+ *          of original, so the output is the same as reducing original itself.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* quotient_expand(Graph* reduced, Graph* original, Quotient* quotient) {
+	int	n = original->vertices_amount,
+		edges = 0;
+	int	*mark = (int*) mem_calloc( quotient->classes + 1, sizeof(int), MEM_SCRATCH );
+	Graph	*g = graph_initializer(n, original->edges_amount, original->flag);
+
+	if ( g == NULL ) {
+		mem_free(mark);
+		return NULL;
+	}
+
+	g->closure_storage = reduced->closure_storage;
+	for ( int u = 0; u < n; u++ ) {
+		graph_add_vertice(g, original->vertices[u]);
+	}
+
+	for ( int u = 0; u < n; u++ ) {
+		int	c = quotient->class[u];
+
+		// Classes kept by the engine, marked with the vertex they are read for
+		for ( int k = 0; k < reduced->edges_neighbours[c]; k++ ) mark[reduced->edges_index[c][k]] = u + 1;
+
+		for ( int k = 0; k < original->edges_neighbours[u]; k++ ) {
+			int	v = original->edges_index[u][k],
+				position = g->edges_neighbours[u];
+
+			if ( mark[quotient->class[v]] != u + 1 ) continue;
+
+			g->edges[u][position] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_GRAPH );
+			strcpy( g->edges[u][position], original->vertices[v] );
+			g->edges_index[u][position] = v;
+			g->edges_neighbours[u]++;
+			edges++;
+		}
+	}
+	g->edges_amount = edges;
+
+	mem_free(mark);
+	return g;
+}
+
+/**
+ * @brief Frees the classes of a graph
+ */
+void quotient_destroy(Quotient* quotient) {
+	if ( quotient == NULL ) return;
+
+	mem_free(quotient->class);
+	mem_free(quotient->representative);
+	mem_free(quotient);
+}
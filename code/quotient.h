@@ -0,0 +1,39 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/quotient.h
+ *
+ * @brief Struct of the quotient of a graph by its equivalent vertices
+ *
+ */
+#ifndef QUOTIENT_H_
+#define QUOTIENT_H_
+
+	/**
+	 * @brief Classes of vertices with the same predecessors and the same neighbours
+	 */
+	typedef struct Quotient {
+		int	 vertices;		/* Vertices of the graph the classes were computed on */
+		int	 classes;		/* Number of classes, the vertices of the quotient graph */
+		int*	 class;			/* Class of each vertex */
+		int*	 representative;	/* First vertex of each class, whose name the class takes */
+	} Quotient;
+
+	extern int quotient_enabled;	/* Set by -q, main reduces the quotient graph and expands the result */
+
+#endif /* QUOTIENT_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Quotient operations
+ */
+/**@{*/
+extern Quotient* quotient_compute(Graph* graph);
+extern Graph*    quotient_apply(Graph* graph, Quotient* quotient);
+extern Graph*    quotient_expand(Graph* reduced, Graph* original, Quotient* quotient);
+extern void      quotient_destroy(Quotient* quotient);
+/**@}*/
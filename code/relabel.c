@@ -0,0 +1,325 @@
+#include "graph.h"
+#include "relabel.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+int relabel_order = RELABEL_NONE;
+
+/**
+ * @brief Order given its name on the command line
+ *
+ * @returns One of the RELABEL_* orders, -1 (ERROR) if the name is unknown
+ */
+int relabel_parse(const char* name) {
+	if ( strcmp(name, "none") == 0 ) return RELABEL_NONE;
+	if ( strcmp(name, "topological") == 0 ) return RELABEL_TOPOLOGICAL;
+	if ( strcmp(name, "bfs") == 0 ) return RELABEL_BFS;
+	if ( strcmp(name, "rcm") == 0 ) return RELABEL_RCM;
+
+	printf("ERROR: Unknown vertex order (%s), expected none, topological, bfs or rcm\n", name);
+	return -1;
+}
+
+/**
+ * @brief Number of edges arriving at each vertex
+ */
+int* relabel_in_degree(Graph* graph) {
+	int	*in = (int*) mem_calloc( graph->vertices_amount + 1, sizeof(int), MEM_SCRATCH );
+
+	for ( int u = 0; u < graph->vertices_amount; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) in[graph->edges_index[u][k]]++;
+	}
+
+	return in;
+}
+
+/**
+ * @brief Reverse of the descendants-first order, so sources come first
+ */
+int* relabel_topological(Graph* graph) {
+	int	*order = graph_descendants_first(graph),
+		n = graph->vertices_amount;
+
+	for ( int i = 0, j = n - 1; i < j; i++, j-- ) {
+		int	aux = order[i];
+
+		order[i] = order[j];
+		order[j] = aux;
+	}
+
+	return order;
+}
+
+/**
+ * @brief Breadth-first order along the edges, started from the sources
+ *
+ * @details Vertices without incoming edges are tried first, in input order,
+ *          then any vertex left, which covers cycles and undirected graphs.
+ */
+int* relabel_bfs(Graph* graph) {
+	int	n = graph->vertices_amount,
+		amount = 0,
+		head = 0;
+	int	*order = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*visited = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH ),
+		*in = relabel_in_degree(graph);
+
+	for ( int pass = 0; pass < 2; pass++ ) {
+		for ( int s = 0; s < n; s++ ) {
+			if ( visited[s] || ( pass == 0 && in[s] > 0 ) ) continue;
+
+			visited[s] = 1;
+			order[amount++] = s;
+			for ( ; head < amount; head++ ) {
+				int	u = order[head];
+
+				for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+					int	w = graph->edges_index[u][k];
+
+					if ( ! visited[w] ) {
+						visited[w] = 1;
+						order[amount++] = w;
+					}
+				}
+			}
+		}
+	}
+
+	mem_free(visited);
+	mem_free(in);
+	return order;
+}
+
+/**
+ * @brief Reverse Cuthill-McKee order of the graph taken as undirected
+ *
+ * @details Every component is walked breadth-first from its vertex of lowest
+ *          degree, visiting the neighbours of a vertex by increasing degree,
+ *          and the whole order is reversed at the end. The lists of neighbours
+ *          come out sorted by degree because they are filled a second time,
+ *          going through the vertices by increasing degree.
+ */
+int* relabel_rcm(Graph* graph) {
+	int	n = graph->vertices_amount,
+		amount = 0,
+		next = 0,
+		max_degree = 0;
+	int	*start = (int*) mem_calloc( n + 2, sizeof(int), MEM_SCRATCH ),
+		*fill = (int*) mem_malloc( sizeof(int) * ( n + 1 ), MEM_SCRATCH ),
+		*by_degree = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*order = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*visited = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH ),
+		*count = NULL,
+		*unsorted = NULL,
+		*adjacent = NULL;
+
+	// Both ends of every edge see each other
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			start[u + 1]++;
+			start[graph->edges_index[u][k] + 1]++;
+		}
+	}
+	for ( int u = 0; u < n; u++ ) {
+		if ( start[u + 1] > max_degree ) max_degree = start[u + 1];
+	}
+
+	// Counting sort of the vertices by degree, ties kept in input order
+	count = (int*) mem_calloc( max_degree + 2, sizeof(int), MEM_SCRATCH );
+	for ( int u = 0; u < n; u++ ) count[start[u + 1] + 1]++;
+	for ( int d = 0; d <= max_degree; d++ ) count[d + 1] += count[d];
+	for ( int u = 0; u < n; u++ ) by_degree[count[start[u + 1]]++] = u;
+	mem_free(count);
+
+	for ( int u = 0; u < n; u++ ) start[u + 1] += start[u];
+	unsorted = (int*) mem_malloc( sizeof(int) * start[n] + 1, MEM_SCRATCH );
+	adjacent = (int*) mem_malloc( sizeof(int) * start[n] + 1, MEM_SCRATCH );
+
+	memcpy(fill, start, sizeof(int) * ( n + 1 ));
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			int	v = graph->edges_index[u][k];
+
+			unsorted[fill[u]++] = v;
+			unsorted[fill[v]++] = u;
+		}
+	}
+
+	memcpy(fill, start, sizeof(int) * ( n + 1 ));
+	for ( int p = 0; p < n; p++ ) {
+		int	x = by_degree[p];
+
+		for ( int k = start[x]; k < start[x + 1]; k++ ) adjacent[fill[unsorted[k]]++] = x;
+	}
+
+	for ( int head = 0; amount < n; head++ ) {
+		// A new component starts from the unvisited vertex of lowest degree
+		if ( head == amount ) {
+			while ( visited[by_degree[next]] ) next++;
+			visited[by_degree[next]] = 1;
+			order[amount++] = by_degree[next];
+		}
+
+		for ( int k = start[order[head]]; k < start[order[head] + 1]; k++ ) {
+			if ( ! visited[adjacent[k]] ) {
+				visited[adjacent[k]] = 1;
+				order[amount++] = adjacent[k];
+			}
+		}
+	}
+
+	for ( int i = 0, j = n - 1; i < j; i++, j-- ) {
+		int	aux = order[i];
+
+		order[i] = order[j];
+		order[j] = aux;
+	}
+
+	mem_free(start);
+	mem_free(fill);
+	mem_free(by_degree);
+	mem_free(visited);
+	mem_free(unsorted);
+	mem_free(adjacent);
+	return order;
+}
+
+/**
+ * @brief Computes a new order of the vertices of a graph
+ *
+ * @param graph Graph to be ordered
+ * @param order One of the RELABEL_* orders
+ *
+ * @returns Array with the old position of the vertex at each new position,
+ *          to be freed by the caller; NULL for RELABEL_NONE
+ */
+int* relabel_compute(Graph* graph, int order) {
+	switch ( order ) {
+		case RELABEL_TOPOLOGICAL:
+			return relabel_topological(graph);
+		case RELABEL_BFS:
+			return relabel_bfs(graph);
+		case RELABEL_RCM:
+			return relabel_rcm(graph);
+		default:
+			return NULL;
+	}
+}
+
+/**
+ * @brief Inverse of an order, the new position of every old one
+ */
+int* relabel_inverse(const int* order, int n) {
+	int	*label = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+
+	for ( int p = 0; p < n; p++ ) label[order[p]] = p;
+	return label;
+}
+
+int relabel_compare(const void* first, const void* second) {
+	return *(const int*) first - *(const int*) second;
+}
+
+/**
+ * @brief Copy of a graph with its vertices in a new order
+ *
+ * @param graph Graph to be copied
+ * @param order Old position of the vertex at each new position, see relabel_compute
+ *
+ * @details Names travel with the vertices, only positions change. Every list
+ *          of neighbours is sorted by new position, so a vertex and the rows
+ *          it reads during closure and reduction are close in memory.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* relabel_apply(Graph* graph, const int* order) {
+	int	n = graph->vertices_amount;
+	int	*label = NULL;
+	Graph	*g = graph_initializer(n, graph->edges_amount, graph->flag);
+
+	if ( g == NULL ) return NULL;
+
+	g->closure_storage = graph->closure_storage;
+	label = relabel_inverse(order, n);
+
+	for ( int p = 0; p < n; p++ ) {
+		graph_add_vertice(g, graph->vertices[order[p]]);
+	}
+
+	for ( int p = 0; p < n; p++ ) {
+		int	u = order[p];
+
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			g->edges_index[p][k] = label[graph->edges_index[u][k]];
+		}
+		g->edges_neighbours[p] = graph->edges_neighbours[u];
+		qsort(g->edges_index[p], g->edges_neighbours[p], sizeof(int), relabel_compare);
+
+		for ( int k = 0; k < g->edges_neighbours[p]; k++ ) {
+			g->edges[p][k] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_GRAPH );
+			strcpy( g->edges[p][k], g->vertices[g->edges_index[p][k]] );
+		}
+	}
+	g->edges_amount = graph->edges_amount;
+
+	mem_free(label);
+	return g;
+}
+
+/**
+ * @brief Brings the result of an engine back to the order of the input
+ *
+ * @param relabelled Graph computed on the output of relabel_apply
+ * @param original Graph given to relabel_apply
+ * @param order Order given to relabel_apply
+ *
+ * @details Vertices get back their input positions and every list of
+ *          neighbours the order of the input, so the output is the same as
+ *          without relabelling. relabelled must only hold edges of original,
+ *          as reductions do.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* relabel_restore(Graph* relabelled, Graph* original, const int* order) {
+	int	n = original->vertices_amount;
+	int	*label = relabel_inverse(order, n),
+		*mark = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+	Graph	*g = graph_initializer(n, relabelled->edges_amount, relabelled->flag);
+
+	if ( g == NULL ) {
+		mem_free(label);
+		mem_free(mark);
+		return NULL;
+	}
+
+	g->closure_storage = relabelled->closure_storage;
+	for ( int u = 0; u < n; u++ ) {
+		graph_add_vertice(g, original->vertices[u]);
+	}
+
+	for ( int u = 0; u < n; u++ ) {
+		int	p = label[u];
+
+		// Neighbours kept by the engine, marked with the vertex they belong to
+		for ( int k = 0; k < relabelled->edges_neighbours[p]; k++ ) mark[relabelled->edges_index[p][k]] = u + 1;
+
+		for ( int k = 0; k < original->edges_neighbours[u]; k++ ) {
+			int	v = original->edges_index[u][k],
+				position = g->edges_neighbours[u];
+
+			if ( mark[label[v]] != u + 1 ) continue;
+
+			g->edges[u][position] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_GRAPH );
+			strcpy( g->edges[u][position], original->vertices[v] );
+			g->edges_index[u][position] = v;
+			g->edges_neighbours[u]++;
+		}
+	}
+	g->edges_amount = relabelled->edges_amount;
+
+	mem_free(label);
+	mem_free(mark);
+	return g;
+}
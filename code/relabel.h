@@ -0,0 +1,39 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/relabel.h
+ *
+ * @brief Definitions of the vertex relabelling done before closure and reduction
+ *
+ */
+#ifndef RELABEL_H_
+#define RELABEL_H_
+
+	/**
+	 * @name Relabel definitions
+	 */
+	/**@{*/
+	#define RELABEL_NONE		0		/* Vertices keep the order of the input */
+	#define RELABEL_TOPOLOGICAL	1		/* Sources first, every edge going forward on acyclic graphs */
+	#define RELABEL_BFS		2		/* Breadth-first order from the sources */
+	#define RELABEL_RCM		3		/* Reverse Cuthill-McKee order of the undirected graph */
+	/**@}*/
+
+	extern int relabel_order;	/* Order applied by main before any engine runs, RELABEL_NONE by default */
+
+#endif /* RELABEL_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Relabel operations
+ */
+/**@{*/
+extern int    relabel_parse(const char* name);
+extern int*   relabel_compute(Graph* graph, int order);
+extern Graph* relabel_apply(Graph* graph, const int* order);
+extern Graph* relabel_restore(Graph* relabelled, Graph* original, const int* order);
+/**@}*/
@@ -0,0 +1,533 @@
+#include "graph.h"
+#include "bitset.h"
+#include "kernels.h"
+#include "roaring.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+  /***** ========== ****/
+ /***** CONTAINERS *****/
+/***** ========== ****/
+
+/**
+ * @brief Frees the storage of a container
+ */
+static void container_free(Container* c) {
+	mem_free(c->values);
+	mem_free(c->bits);
+	c->values = NULL;
+	c->bits = NULL;
+}
+
+/**
+ * @brief Position of the first array value not smaller than low
+ */
+static int container_lower_bound(Container* c, int low) {
+	int	first = 0,
+		last = c->amount;
+
+	while ( first < last ) {
+		int	middle = ( first + last ) / 2;
+
+		if ( c->values[middle] < low ) first = middle + 1;
+		else last = middle;
+	}
+
+	return first;
+}
+
+/**
+ * @brief Checks if a container has a value
+ */
+static int container_contains(Container* c, int low) {
+	if ( c->type == CONTAINER_BITMAP ) {
+		return ( c->bits[low / WORD_BITS] >> ( low % WORD_BITS ) ) & 1;
+	}
+
+	if ( c->type == CONTAINER_ARRAY ) {
+		int	position = container_lower_bound(c, low);
+
+		return position < c->amount && c->values[position] == low;
+	}
+
+	// Last run starting at or before low
+	int	first = 0,
+		last = c->amount - 1,
+		found = -1;
+
+	while ( first <= last ) {
+		int	middle = ( first + last ) / 2;
+
+		if ( c->values[2 * middle] <= low ) {
+			found = middle;
+			first = middle + 1;
+		} else {
+			last = middle - 1;
+		}
+	}
+
+	return found != -1 && low <= c->values[2 * found] + c->values[2 * found + 1];
+}
+
+/**
+ * @brief Writes the sorted values of a container
+ *
+ * @returns Number of values written
+ */
+static int container_values(Container* c, uint16_t* out) {
+	int	amount = 0;
+
+	if ( c->type == CONTAINER_ARRAY ) {
+		memcpy(out, c->values, sizeof(uint16_t) * c->amount);
+		return c->amount;
+	}
+
+	if ( c->type == CONTAINER_RUN ) {
+		for ( int r = 0; r < c->amount; r++ ) {
+			for ( int v = c->values[2 * r]; v <= c->values[2 * r] + c->values[2 * r + 1]; v++ ) {
+				out[amount++] = (uint16_t) v;
+			}
+		}
+		return amount;
+	}
+
+	for ( int w = 0; w < ROARING_BITMAP_WORDS; w++ ) {
+		WORD	word = c->bits[w];
+
+		while ( word ) {
+			out[amount++] = (uint16_t) ( w * WORD_BITS + __builtin_ctzll(word) );
+			word &= word - 1;
+		}
+	}
+	return amount;
+}
+
+/**
+ * @brief Rebuilds a container of given type from sorted values
+ */
+static void container_build(Container* c, int type, uint16_t* values, int amount) {
+	container_free(c);
+	c->type = type;
+	c->cardinality = amount;
+
+	if ( type == CONTAINER_BITMAP ) {
+		c->bits = (WORD*) mem_calloc( ROARING_BITMAP_WORDS, sizeof(WORD), MEM_CLOSURE );
+		for ( int i = 0; i < amount; i++ ) {
+			c->bits[values[i] / WORD_BITS] |= (WORD) 1 << ( values[i] % WORD_BITS );
+		}
+		c->amount = 0;
+		c->allocated = 0;
+	} else if ( type == CONTAINER_ARRAY ) {
+		c->allocated = amount > 0 ? amount : 1;
+		c->values = (uint16_t*) mem_malloc( sizeof(uint16_t) * c->allocated, MEM_CLOSURE );
+		if ( amount > 0 ) memcpy(c->values, values, sizeof(uint16_t) * amount);
+		c->amount = amount;
+	} else {
+		c->amount = 0;
+		c->allocated = 1;
+		for ( int i = 1; i < amount; i++ ) {
+			if ( values[i] != values[i - 1] + 1 ) c->allocated++;
+		}
+		c->values = (uint16_t*) mem_malloc( sizeof(uint16_t) * 2 * c->allocated, MEM_CLOSURE );
+		for ( int i = 0; i < amount; i++ ) {
+			if ( c->amount > 0 && values[i] == c->values[2 * ( c->amount - 1 )] + c->values[2 * ( c->amount - 1 ) + 1] + 1 ) {
+				c->values[2 * ( c->amount - 1 ) + 1]++;
+			} else {
+				c->values[2 * c->amount] = values[i];
+				c->values[2 * c->amount + 1] = 0;
+				c->amount++;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Turns a container into a bitmap container
+ */
+static void container_to_bitmap(Container* c) {
+	uint16_t	*values = NULL;
+	int	amount = 0;
+
+	if ( c->type == CONTAINER_BITMAP ) return;
+
+	values = (uint16_t*) mem_malloc( sizeof(uint16_t) * ( c->cardinality + 1 ), MEM_CLOSURE );
+	amount = container_values(c, values);
+	container_build(c, CONTAINER_BITMAP, values, amount);
+	mem_free(values);
+}
+
+/**
+ * @brief Inserts a value in a container
+ *
+ * @details Run containers are turned into bitmaps first, roaring_optimize
+ *          brings back the run form when it is the smallest one.
+ */
+static void container_add(Container* c, int low) {
+	if ( container_contains(c, low) ) return;
+
+	if ( c->type == CONTAINER_RUN || ( c->type == CONTAINER_ARRAY && c->amount >= ROARING_ARRAY_MAX ) ) {
+		container_to_bitmap(c);
+	}
+
+	if ( c->type == CONTAINER_BITMAP ) {
+		c->bits[low / WORD_BITS] |= (WORD) 1 << ( low % WORD_BITS );
+	} else {
+		int	position = container_lower_bound(c, low);
+
+		if ( c->amount == c->allocated ) {
+			c->allocated = c->allocated * 2;
+			c->values = (uint16_t*) mem_realloc( c->values, sizeof(uint16_t) * c->allocated, MEM_CLOSURE );
+		}
+		memmove(c->values + position + 1, c->values + position, sizeof(uint16_t) * ( c->amount - position ));
+		c->values[position] = (uint16_t) low;
+		c->amount++;
+	}
+	c->cardinality++;
+}
+
+/**
+ * @brief Adds every value of source to destination
+ *
+ * @details Two arrays are merged and two run containers have their runs
+ *          merged; any other pair is computed as a bitmap.
+ */
+static void container_union(Container* destination, Container* source) {
+	if ( ( destination->type == CONTAINER_ARRAY && source->type == CONTAINER_ARRAY ) ||
+	     ( destination->type == CONTAINER_RUN && source->type == CONTAINER_RUN ) ) {
+		uint16_t	*first = (uint16_t*) mem_malloc( sizeof(uint16_t) * ( destination->cardinality + 1 ), MEM_CLOSURE ),
+				*second = (uint16_t*) mem_malloc( sizeof(uint16_t) * ( source->cardinality + 1 ), MEM_CLOSURE ),
+				*merged = (uint16_t*) mem_malloc( sizeof(uint16_t) * ( destination->cardinality + source->cardinality + 1 ), MEM_CLOSURE );
+		int	first_amount = container_values(destination, first),
+			second_amount = container_values(source, second),
+			i = 0,
+			j = 0,
+			amount = 0;
+
+		while ( i < first_amount || j < second_amount ) {
+			if ( j == second_amount || ( i < first_amount && first[i] < second[j] ) ) merged[amount++] = first[i++];
+			else if ( i == first_amount || second[j] < first[i] ) merged[amount++] = second[j++];
+			else { merged[amount++] = first[i++]; j++; }
+		}
+
+		if ( destination->type == CONTAINER_ARRAY && amount > ROARING_ARRAY_MAX ) {
+			container_build(destination, CONTAINER_BITMAP, merged, amount);
+		} else {
+			container_build(destination, destination->type, merged, amount);
+		}
+
+		mem_free(first);
+		mem_free(second);
+		mem_free(merged);
+		return;
+	}
+
+	container_to_bitmap(destination);
+	if ( source->type == CONTAINER_BITMAP ) {
+		kernels.row_union(destination->bits, source->bits, ROARING_BITMAP_WORDS);
+	} else if ( source->type == CONTAINER_ARRAY ) {
+		for ( int i = 0; i < source->amount; i++ ) {
+			destination->bits[source->values[i] / WORD_BITS] |= (WORD) 1 << ( source->values[i] % WORD_BITS );
+		}
+	} else {
+		for ( int r = 0; r < source->amount; r++ ) {
+			for ( int v = source->values[2 * r]; v <= source->values[2 * r] + source->values[2 * r + 1]; v++ ) {
+				destination->bits[v / WORD_BITS] |= (WORD) 1 << ( v % WORD_BITS );
+			}
+		}
+	}
+	destination->cardinality = (int) kernels.row_popcount(destination->bits, ROARING_BITMAP_WORDS);
+}
+
+/**
+ * @brief Checks if two containers hold the same values, whatever their type
+ */
+static int container_equal(Container* first, Container* second) {
+	int	equal = 1;
+
+	if ( first->cardinality != second->cardinality ) return 0;
+
+	if ( first->type == second->type ) {
+		if ( first->type == CONTAINER_BITMAP ) return kernels.row_equal(first->bits, second->bits, ROARING_BITMAP_WORDS);
+		if ( first->amount != second->amount ) return 0;
+		return memcmp(first->values, second->values, sizeof(uint16_t) * first->amount * ( first->type == CONTAINER_RUN ? 2 : 1 )) == 0;
+	}
+
+	// Same cardinality, so the sets are equal if second has every value of first
+	uint16_t	*values = (uint16_t*) mem_malloc( sizeof(uint16_t) * ( first->cardinality + 1 ), MEM_CLOSURE );
+	int	amount = container_values(first, values);
+
+	for ( int i = 0; i < amount && equal; i++ ) {
+		equal = container_contains(second, values[i]);
+	}
+
+	mem_free(values);
+	return equal;
+}
+
+/**
+ * @brief Stores a container in its smallest form
+ *
+ * @details An array takes 2 bytes per value, a bitmap 8KB and a run
+ *          container 4 bytes per run.
+ */
+static void container_optimize(Container* c) {
+	uint16_t	*values = (uint16_t*) mem_malloc( sizeof(uint16_t) * ( c->cardinality + 1 ), MEM_CLOSURE );
+	int	amount = container_values(c, values),
+		runs = amount > 0 ? 1 : 0,
+		type = CONTAINER_BITMAP;
+	long	smallest = sizeof(WORD) * ROARING_BITMAP_WORDS;
+
+	for ( int i = 1; i < amount; i++ ) {
+		if ( values[i] != values[i - 1] + 1 ) runs++;
+	}
+
+	if ( (long) sizeof(uint16_t) * amount < smallest ) {
+		smallest = sizeof(uint16_t) * amount;
+		type = CONTAINER_ARRAY;
+	}
+	if ( (long) sizeof(uint16_t) * 2 * runs < smallest ) {
+		type = CONTAINER_RUN;
+	}
+
+	if ( type != c->type ) container_build(c, type, values, amount);
+	mem_free(values);
+}
+
+  /***** ======= ****/
+ /***** ROARING *****/
+/***** ======= ****/
+
+/**
+ * @brief Initializes an empty compressed bitmap
+ *
+ * @returns Reference to newly create Roaring
+ */
+Roaring* roaring_initializer(void) {
+	return (Roaring*) mem_calloc( 1, sizeof(Roaring), MEM_CLOSURE );
+}
+
+/**
+ * @brief Frees a compressed bitmap
+ */
+void roaring_destroy(Roaring* r) {
+	if ( r == NULL ) return;
+
+	for ( int i = 0; i < r->amount; i++ ) container_free(&r->containers[i]);
+	mem_free(r->keys);
+	mem_free(r->containers);
+	mem_free(r);
+}
+
+/**
+ * @brief Position of the container of given key, -1 if missing
+ *
+ * @details With create set, a missing container is inserted as an empty array
+ */
+static int roaring_container(Roaring* r, int key, int create) {
+	int	first = 0,
+		last = r->amount;
+
+	while ( first < last ) {
+		int	middle = ( first + last ) / 2;
+
+		if ( r->keys[middle] < key ) first = middle + 1;
+		else last = middle;
+	}
+
+	if ( first < r->amount && r->keys[first] == key ) return first;
+	if ( ! create ) return -1;
+
+	if ( r->amount == r->allocated ) {
+		r->allocated = r->allocated == 0 ? 1 : r->allocated * 2;
+		r->keys = (uint16_t*) mem_realloc( r->keys, sizeof(uint16_t) * r->allocated, MEM_CLOSURE );
+		r->containers = (Container*) mem_realloc( r->containers, sizeof(Container) * r->allocated, MEM_CLOSURE );
+	}
+	memmove(r->keys + first + 1, r->keys + first, sizeof(uint16_t) * ( r->amount - first ));
+	memmove(r->containers + first + 1, r->containers + first, sizeof(Container) * ( r->amount - first ));
+	r->keys[first] = (uint16_t) key;
+	memset(&r->containers[first], 0, sizeof(Container));
+	container_build(&r->containers[first], CONTAINER_ARRAY, NULL, 0);
+	r->amount++;
+
+	return first;
+}
+
+/**
+ * @brief Inserts a value
+ *
+ * @param r Bitmap that will have the new value
+ * @param value Non-negative value to be inserted
+ */
+void roaring_add(Roaring* r, int value) {
+	int	position = roaring_container(r, value >> 16, 1);
+
+	container_add(&r->containers[position], value & 0xFFFF);
+}
+
+/**
+ * @brief Checks if a value was inserted
+ *
+ * @returns 1 if found, otherwise 0
+ */
+int roaring_contains(Roaring* r, int value) {
+	int	position = roaring_container(r, value >> 16, 0);
+
+	return position != -1 && container_contains(&r->containers[position], value & 0xFFFF);
+}
+
+/**
+ * @brief Adds every value of source to destination, on the compressed form
+ */
+void roaring_union(Roaring* destination, Roaring* source) {
+	for ( int i = 0; i < source->amount; i++ ) {
+		int	position = roaring_container(destination, source->keys[i], 1);
+
+		container_union(&destination->containers[position], &source->containers[i]);
+	}
+}
+
+/**
+ * @brief Checks if two bitmaps hold the same values
+ *
+ * @returns 1 if equal, otherwise 0
+ */
+int roaring_equal(Roaring* first, Roaring* second) {
+	// Containers are only created to hold a value, so equal sets have the same keys
+	if ( first->amount != second->amount ) return 0;
+
+	for ( int i = 0; i < first->amount; i++ ) {
+		if ( first->keys[i] != second->keys[i] || ! container_equal(&first->containers[i], &second->containers[i]) ) return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Number of values in a bitmap
+ */
+long roaring_cardinality(Roaring* r) {
+	long	cardinality = 0;
+
+	for ( int i = 0; i < r->amount; i++ ) cardinality += r->containers[i].cardinality;
+	return cardinality;
+}
+
+/**
+ * @brief Stores every container of a bitmap in its smallest form
+ */
+void roaring_optimize(Roaring* r) {
+	for ( int i = 0; i < r->amount; i++ ) container_optimize(&r->containers[i]);
+}
+
+/**
+ * @brief Writes the values of a bitmap in increasing order
+ *
+ * @param r Bitmap to be iterated
+ * @param values Receives the values, room for roaring_cardinality(r) of them
+ *
+ * @returns Number of values written
+ */
+int roaring_to_array(Roaring* r, int* values) {
+	uint16_t	*low = (uint16_t*) mem_malloc( sizeof(uint16_t) * ROARING_CHUNK, MEM_CLOSURE );
+	int	amount = 0;
+
+	for ( int i = 0; i < r->amount; i++ ) {
+		int	low_amount = container_values(&r->containers[i], low);
+
+		for ( int k = 0; k < low_amount; k++ ) {
+			values[amount++] = ( (int) r->keys[i] << 16 ) | low[k];
+		}
+	}
+
+	mem_free(low);
+	return amount;
+}
+
+/**
+ * @brief Bytes used by a bitmap and its containers
+ */
+long roaring_size_in_bytes(Roaring* r) {
+	long	size = sizeof(Roaring) + ( sizeof(uint16_t) + sizeof(Container) ) * r->allocated;
+
+	for ( int i = 0; i < r->amount; i++ ) {
+		Container	*c = &r->containers[i];
+
+		if ( c->type == CONTAINER_BITMAP ) size += sizeof(WORD) * ROARING_BITMAP_WORDS;
+		else size += sizeof(uint16_t) * c->allocated * ( c->type == CONTAINER_RUN ? 2 : 1 );
+	}
+
+	return size;
+}
+
+/**
+ * @brief Constructs direct transitive closure of all graph vertices as compressed bitmaps
+ *
+ * @param graph Graph to be iterated
+ *
+ * @details Used by direct_transitive_closure when Graph::closure_storage is
+ *          CLOSURE_COMPRESSED. On an acyclic directed graph the vertices are
+ *          taken descendants first and each row is the union, on the
+ *          compressed form, of its neighbours' rows and the neighbours
+ *          themselves. Other graphs get one depth-first search per vertex.
+ *          Only the sizes of the rows are kept in Graph::num_transitive_closure,
+ *          the names of Graph::transitive_closure are not materialised, which
+ *          would cost more than the rows save; graph_closure_contains and
+ *          roaring_to_array read them.
+ */
+void roaring_transitive_closure(Graph* graph) {
+	int	n = graph->vertices_amount,
+		top = -1;
+	int	*stack = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*visited = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+
+	graph->closure_compressed = (Roaring**) mem_calloc( n + 1, sizeof(Roaring*), MEM_CLOSURE );
+
+	if ( graph->flag == DIRECTED && ! isCyclic(graph) ) {
+		int	*order = graph_descendants_first(graph);
+
+		for ( int p = 0; p < n; p++ ) {
+			int	u = order[p];
+			Roaring	*row = roaring_initializer();
+
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+				roaring_union(row, graph->closure_compressed[graph->edges_index[u][k]]);
+				roaring_add(row, graph->edges_index[u][k]);
+			}
+			roaring_optimize(row);
+			graph->closure_compressed[u] = row;
+		}
+		mem_free(order);
+	} else {
+		for ( int i = 0; i < n; i++ ) {
+			Roaring	*row = roaring_initializer();
+
+			// Visited marks hold the source + 1, so they never need clearing
+			visited[i] = i + 1;
+			stack[++top] = i;
+			while ( top >= 0 ) {
+				int	v = stack[top--];
+
+				for ( int k = 0; k < graph->edges_neighbours[v]; k++ ) {
+					int	w = graph->edges_index[v][k];
+
+					if ( visited[w] != i + 1 ) {
+						visited[w] = i + 1;
+						roaring_add(row, w);
+						stack[++top] = w;
+					}
+				}
+			}
+			roaring_optimize(row);
+			graph->closure_compressed[i] = row;
+		}
+	}
+
+	for ( int i = 0; i < n; i++ ) {
+		graph->num_transitive_closure[i] = (int) roaring_cardinality(graph->closure_compressed[i]);
+	}
+
+	mem_free(stack);
+	mem_free(visited);
+}
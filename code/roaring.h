@@ -0,0 +1,78 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/roaring.h
+ *
+ * @brief Struct of a compressed bitmap (Roaring layout) for closure rows
+ *
+ */
+#ifndef ROARING_H_
+#define ROARING_H_
+
+	#include <stdint.h>
+
+	/**
+	 * @name Roaring definitions
+	 */
+	/**@{*/
+	#define ROARING_CHUNK		65536		/* Values covered by one container (low 16 bits) */
+	#define ROARING_BITMAP_WORDS	1024		/* WORDs of a bitmap container */
+	#define ROARING_ARRAY_MAX	4096		/* Above this cardinality an array is bigger than a bitmap */
+	#define CONTAINER_ARRAY		0		/* Sorted 16-bit values */
+	#define CONTAINER_BITMAP	1		/* One bit per value of the chunk */
+	#define CONTAINER_RUN		2		/* Sorted pairs (start, length - 1) of consecutive values */
+	/**@}*/
+
+	typedef struct Container {
+
+		/**
+		 * @name Container of the values sharing the same high 16 bits
+		 */
+		/**@{*/
+		int		type;		/* One of the CONTAINER_* values */
+		int		cardinality;	/* Number of values in the container */
+		int		amount;		/* Values of an array, runs of a run container */
+		int		allocated;	/* Capacity of values, in values or in runs */
+		uint16_t*	values;		/* Array and run containers */
+		WORD*		bits;		/* Bitmap containers */
+		/**@}*/
+
+	} Container;
+
+	typedef struct Roaring {
+
+		/**
+		 * @name Compressed bitmap information
+		 */
+		/**@{*/
+		int		amount;		/* Number of containers */
+		int		allocated;	/* Capacity of keys and containers */
+		uint16_t*	keys;		/* High 16 bits of each container, sorted */
+		Container*	containers;	/* Containers, parallel to keys */
+		/**@}*/
+
+	} Roaring;
+
+#endif /* ROARING_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Roaring operations
+ */
+/**@{*/
+extern Roaring* roaring_initializer(void);
+extern void roaring_destroy(Roaring* r);
+extern void roaring_add(Roaring* r, int value);
+extern int  roaring_contains(Roaring* r, int value);
+extern void roaring_union(Roaring* destination, Roaring* source);
+extern int  roaring_equal(Roaring* first, Roaring* second);
+extern long roaring_cardinality(Roaring* r);
+extern void roaring_optimize(Roaring* r);
+extern int  roaring_to_array(Roaring* r, int* values);
+extern long roaring_size_in_bytes(Roaring* r);
+extern void roaring_transitive_closure(Graph* graph);
+/**@}*/
@@ -0,0 +1,225 @@
+#include "graph.h"
+#include "bitset.h"
+#include "kernels.h"
+#include "overlay.h"
+#include "binary.h"
+#include "wavefront.h"
+#include "shard.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+int shard_workers = SHARD_DISABLED;
+
+/**
+ * @brief Address of a section of the segment
+ */
+void* shard_section(ShardSegment* segment, long offset) {
+	return (char*) segment + offset;
+}
+
+/**
+ * @brief Reduces the share of each level that belongs to a worker
+ *
+ * @param segment Segment shared by the coordinator and the workers
+ * @param id Worker number
+ *
+ * @details As in wavefront_worker, the vertices of a level are split in
+ *          contiguous blocks, here one per process. Each worker marks the
+ *          edges it keeps in its own bitmap, so two workers never write the
+ *          same word.
+ */
+void shard_worker(ShardSegment* segment, int id) {
+	BinaryGraph	*image = (BinaryGraph*) shard_section(segment, segment->graph);
+	int	*offsets = binary_graph_offsets(image),
+		*targets = binary_graph_targets(image),
+		*level_start = (int*) shard_section(segment, segment->level_start),
+		*order = (int*) shard_section(segment, segment->order),
+		words = segment->words_per_row;
+	WORD	*closure = (WORD*) shard_section(segment, segment->closure),
+		*keep = (WORD*) shard_section(segment, segment->keep) + (size_t) id * segment->keep_words;
+
+	for ( int l = 0; l < segment->levels_amount; l++ ) {
+		long	size = level_start[l + 1] - level_start[l];
+		int	first = level_start[l] + (int) ( size * id / segment->workers ),
+			last = level_start[l] + (int) ( size * ( id + 1 ) / segment->workers );
+
+		for ( int p = first; p < last; p++ ) {
+			int	u = order[p];
+			WORD	*row = closure + (size_t) u * words;
+
+			for ( int k = offsets[u]; k < offsets[u + 1]; k++ ) {
+				kernels.row_union(row, closure + (size_t) targets[k] * words, words);
+			}
+
+			// A neighbour reached through another one is a redundant edge
+			for ( int k = offsets[u]; k < offsets[u + 1]; k++ ) {
+				if ( ( ( row[targets[k] / WORD_BITS] >> ( targets[k] % WORD_BITS ) ) & 1 ) == 0 ) {
+					keep[k / WORD_BITS] |= (WORD) 1 << ( k % WORD_BITS );
+				}
+			}
+			for ( int k = offsets[u]; k < offsets[u + 1]; k++ ) {
+				row[targets[k] / WORD_BITS] |= (WORD) 1 << ( targets[k] % WORD_BITS );
+			}
+		}
+
+		pthread_barrier_wait(&segment->barrier);
+	}
+}
+
+/**
+ * @brief Transitive reduction of a directed acyclic graph by several processes
+ *
+ * @param view View without changes yet, its redundant edges are removed
+ * @param workers Number of worker processes
+ *
+ * @details The coordinator writes the graph in binary form, its levels and
+ *          room for the closure into a POSIX shared-memory segment, then forks
+ *          the workers. Every worker sweeps the levels with the others, a
+ *          process-shared barrier between two levels, and reduces its shard of
+ *          the sources of each level. Once all of them exit, the coordinator
+ *          merges their kept-edge bitmaps in the segment and removes the other
+ *          edges from the view. The view is left untouched on ERROR.
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int shard_reduce(Overlay* view, int workers) {
+	Graph	*graph = view->base;
+	ShardSegment	*segment = NULL,
+			layout;
+	pthread_barrierattr_t	attribute;
+	pid_t	pids[SHARD_MAX_WORKERS];
+	char	name[SHARD_NAME_SIZE];
+	int	n = graph->vertices_amount,
+		levels_amount = 0,
+		created = 0,
+		failed = 0,
+		entries = 0,
+		fd = -1;
+	int	*level = wavefront_levels(graph, &levels_amount),
+		*level_start = NULL,
+		*order = NULL;
+	long	size = 0;
+
+	if ( workers > SHARD_MAX_WORKERS ) workers = SHARD_MAX_WORKERS;
+	if ( workers < 1 ) workers = 1;
+
+	for ( int i = 0; i < n; i++ ) entries += graph->edges_neighbours[i];
+
+	// Sections of the segment
+	memset(&layout, 0, sizeof(ShardSegment));
+	layout.workers = workers;
+	layout.levels_amount = levels_amount;
+	layout.words_per_row = ( n + WORD_BITS - 1 ) / WORD_BITS;
+	layout.keep_words = entries / WORD_BITS + 1;
+	layout.graph = ( sizeof(ShardSegment) + BINARY_ALIGN - 1 ) / BINARY_ALIGN * BINARY_ALIGN;
+	layout.level_start = layout.graph + binary_graph_size(graph);
+	layout.order = layout.level_start + (long) sizeof(int) * ( levels_amount + 2 );
+	layout.closure = ( layout.order + (long) sizeof(int) * n + BINARY_ALIGN - 1 ) / BINARY_ALIGN * BINARY_ALIGN;
+	layout.keep = layout.closure + (long) sizeof(WORD) * n * layout.words_per_row;
+	layout.kept = layout.keep + (long) sizeof(WORD) * layout.keep_words * workers;
+	layout.size = layout.kept + (long) sizeof(WORD) * layout.keep_words;
+	size = layout.size;
+
+	snprintf(name, SHARD_NAME_SIZE, "/transitive-reduction.%d", (int) getpid());
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if ( fd < 0 ) {
+		printf("ERROR: The shared-memory segment (%s) could not be created\n", name);
+		mem_free(level);
+		return -1;
+	}
+
+	// The segment is only reachable through the mapping, inherited by fork
+	shm_unlink(name);
+
+	if ( ftruncate(fd, size) != 0 ||
+	     ( segment = (ShardSegment*) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) ) == MAP_FAILED ) {
+		printf("ERROR: The shared-memory segment (%s) could not be mapped with %ld bytes\n", name, size);
+		close(fd);
+		mem_free(level);
+		return -1;
+	}
+	close(fd);
+
+	// ftruncate leaves the segment filled with zeros, closure rows and bitmaps included
+	memcpy(segment, &layout, sizeof(ShardSegment));
+	binary_graph_write(graph, shard_section(segment, segment->graph));
+
+	// Counting sort of the vertices by level
+	level_start = (int*) shard_section(segment, segment->level_start);
+	order = (int*) shard_section(segment, segment->order);
+	for ( int u = 0; u < n; u++ ) level_start[level[u] + 1]++;
+	for ( int l = 0; l < levels_amount; l++ ) level_start[l + 1] += level_start[l];
+	for ( int u = 0; u < n; u++ ) order[level_start[level[u]]++] = u;
+	for ( int l = levels_amount; l > 0; l-- ) level_start[l] = level_start[l - 1];
+	level_start[0] = 0;
+	mem_free(level);
+
+	pthread_barrierattr_init(&attribute);
+	pthread_barrierattr_setpshared(&attribute, PTHREAD_PROCESS_SHARED);
+	pthread_barrier_init(&segment->barrier, &attribute, workers);
+	pthread_barrierattr_destroy(&attribute);
+
+	fflush(stdout);
+	for ( ; created < workers; created++ ) {
+		pids[created] = fork();
+
+		if ( pids[created] == 0 ) {
+			shard_worker(segment, created);
+			_exit(0);
+		}
+		if ( pids[created] < 0 ) {
+			printf("ERROR: Worker %d of %d could not be started\n", created, workers);
+			failed = 1;
+			break;
+		}
+	}
+
+	// Once a worker is missing, the others would wait forever at the barrier
+	if ( failed ) {
+		for ( int w = 0; w < created; w++ ) kill(pids[w], SIGKILL);
+	}
+	for ( int remaining = created; remaining > 0; remaining-- ) {
+		int	status = 0;
+
+		if ( waitpid(-1, &status, 0) < 0 ) {
+			failed = 1;
+			break;
+		}
+		if ( ! WIFEXITED(status) || WEXITSTATUS(status) != 0 ) {
+			if ( ! failed ) {
+				for ( int w = 0; w < created; w++ ) kill(pids[w], SIGKILL);
+			}
+			failed = 1;
+		}
+	}
+
+	if ( ! failed ) {
+		WORD	*kept = (WORD*) shard_section(segment, segment->kept);
+		int	position = 0;
+
+		for ( int w = 0; w < workers; w++ ) {
+			kernels.row_union(kept, (WORD*) shard_section(segment, segment->keep) + (size_t) w * segment->keep_words, segment->keep_words);
+		}
+
+		for ( int u = 0; u < n; u++ ) {
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++, position++ ) {
+				if ( ( ( kept[position / WORD_BITS] >> ( position % WORD_BITS ) ) & 1 ) == 0 ) {
+					overlay_delete_edge(view, u, graph->edges_index[u][k]);
+				}
+			}
+		}
+	} else {
+		printf("ERROR: The sharded reduction did not finish\n");
+	}
+
+	pthread_barrier_destroy(&segment->barrier);
+	munmap(segment, size);
+	return failed ? -1 : 0;
+}
@@ -0,0 +1,73 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/shard.h
+ *
+ * @brief Struct of a reduction split between worker processes over shared memory
+ *
+ */
+#ifndef SHARD_H_
+#define SHARD_H_
+
+	#include <pthread.h>
+
+	/**
+	 * @name Shard definitions
+	 */
+	/**@{*/
+	#define SHARD_DISABLED		0		/* walk() keeps the reduction in one process */
+	#define SHARD_MAX_WORKERS	256		/* Upper bound on the number of worker processes */
+	#define SHARD_NAME_SIZE		64		/* Size of the name of the shared-memory segment */
+	/**@}*/
+
+	struct Overlay;		/* Copy-on-write view of a graph, see overlay.h */
+
+	typedef struct ShardSegment {
+
+		/**
+		 * @name Synchronization of the workers
+		 */
+		/**@{*/
+		pthread_barrier_t	barrier;	/* Process-shared, separates two levels */
+		int			workers;	/* Number of worker processes */
+		/**@}*/
+
+		/**
+		 * @name Sizes
+		 */
+		/**@{*/
+		int	levels_amount;		/* Number of levels, see wavefront_levels */
+		int	words_per_row;		/* WORDs of a closure row */
+		int	keep_words;		/* WORDs of a kept-edge bitmap, one bit per neighbour listed */
+		/**@}*/
+
+		/**
+		 * @name Sections, as byte offsets from the start of the segment
+		 */
+		/**@{*/
+		long	graph;			/* BinaryGraph of the graph being reduced */
+		long	level_start;		/* First position in order of each level, plus one past the last */
+		long	order;			/* Vertices sorted by level, sinks first */
+		long	closure;		/* Closure rows */
+		long	keep;			/* Kept-edge bitmap of each worker */
+		long	kept;			/* Kept-edge bitmaps of the workers merged */
+		long	size;			/* Bytes of the whole segment */
+		/**@}*/
+
+	} ShardSegment;
+
+	extern int shard_workers;	/* Worker processes used by walk(), SHARD_DISABLED for none */
+
+#endif /* SHARD_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Shard operations
+ */
+/**@{*/
+extern int shard_reduce(struct Overlay* view, int workers);
+/**@}*/
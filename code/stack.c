@@ -1,4 +1,5 @@
 #include "stack.h"
+#include "memtrack.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -18,9 +19,9 @@ Stack* initStack(int number_of_vertices) {
 		return NULL;
 	}
 
-    Stack *s = (Stack*) malloc( sizeof(Stack) );
+    Stack *s = (Stack*) mem_malloc( sizeof(Stack), MEM_STACK );
 
-    s->stack = (STRING*) malloc( sizeof(STRING) * number_of_vertices + 1 );
+    s->stack = (STRING*) mem_malloc( sizeof(STRING) * number_of_vertices + 1, MEM_STACK );
 
     s->top = -1;
 
@@ -67,7 +68,7 @@ void push(Stack* s, STRING vertice) {
         return;
     }
     s->top++;
-    s->stack[s->top] = (STRING) malloc( sizeof(char) * STR_SIZE + 1);
+    s->stack[s->top] = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_STACK);
     strcpy(s->stack[s->top], "");
     strcpy(s->stack[s->top], vertice);
 }
@@ -86,7 +87,7 @@ STRING pop(Stack* s) {
         printf("ERROR: Stack underflow\n");
         return "";
     }
-    STRING vertice = (STRING) malloc( sizeof(char) * STR_SIZE + 1);
+    STRING vertice = (STRING) mem_malloc( sizeof(char) * STR_SIZE + 1, MEM_STACK);
     strcpy(vertice, "");
     strcpy(vertice, s->stack[s->top]);
     s->top--;
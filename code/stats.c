@@ -0,0 +1,201 @@
+#include "graph.h"
+#include "bitset.h"
+#include "chain.h"
+#include "stats.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+int stats_engine = STATS_ENGINE_AUTO;
+int stats_storage = STATS_STORAGE_AUTO;
+long stats_dense_bytes = STATS_DENSE_CLOSURE_BYTES;
+
+/**
+ * @brief Engine given its name on the command line
+ *
+ * @returns One of the STATS_ENGINE_* values, -1 (ERROR) if the name is unknown
+ */
+int stats_engine_parse(const char* name) {
+	if ( strcmp(name, "auto") == 0 ) return STATS_ENGINE_AUTO;
+	if ( strcmp(name, "walk") == 0 ) return STATS_ENGINE_WALK;
+	if ( strcmp(name, "chain") == 0 ) return STATS_ENGINE_CHAIN;
+	if ( strcmp(name, "permutation") == 0 ) return STATS_ENGINE_PERMUTATION;
+
+	printf("ERROR: Unknown engine (%s), expected auto, walk, chain or permutation\n", name);
+	return -1;
+}
+
+/**
+ * @brief Printable name of an engine
+ */
+const char* stats_engine_name(int engine) {
+	switch ( engine ) {
+		case STATS_ENGINE_WALK:		return "walk";
+		case STATS_ENGINE_CHAIN:	return "chain";
+		case STATS_ENGINE_PERMUTATION:	return "permutation";
+		default:			return "auto";
+	}
+}
+
+/**
+ * @brief Closure storage given its name on the command line
+ *
+ * @returns CLOSURE_DENSE, CLOSURE_COMPRESSED, CLOSURE_LAZY or STATS_STORAGE_AUTO, -2 (ERROR) if the name is unknown
+ */
+int stats_storage_parse(const char* name) {
+	if ( strcmp(name, "auto") == 0 ) return STATS_STORAGE_AUTO;
+	if ( strcmp(name, "dense") == 0 ) return CLOSURE_DENSE;
+	if ( strcmp(name, "compressed") == 0 ) return CLOSURE_COMPRESSED;
+	if ( strcmp(name, "lazy") == 0 ) return CLOSURE_LAZY;
+
+	printf("ERROR: Unknown closure storage (%s), expected auto, dense, compressed or lazy\n", name);
+	return -2;
+}
+
+/**
+ * @brief Measures the shape of a graph
+ *
+ * @param graph Graph to be iterated
+ * @param stats Receives the statistics
+ *
+ * @details One pass over the lists gives the degrees and the number of edges
+ *          arriving at each vertex; on a directed graph a second one removes
+ *          the sources level by level (Kahn's algorithm), which tells whether
+ *          the graph is acyclic, its depth and how many vertices share a
+ *          level. Both passes are O(V + E), nothing close to a closure.
+ */
+void stats_compute(Graph* graph, GraphStats* stats) {
+	int	n = graph->vertices_amount,
+		head = 0,
+		tail = 0;
+	long	neighbours = 0;
+	int	*in = NULL,
+		*level = NULL,
+		*queue = NULL,
+		*amount = NULL;
+
+	memset(stats, 0, sizeof(GraphStats));
+	stats->vertices = n;
+	stats->edges = graph->edges_amount;
+	stats->density = graph_density(graph);
+	stats->depth = -1;
+	stats->width = -1;
+
+	for ( int u = 0; u < n; u++ ) {
+		neighbours += graph->edges_neighbours[u];
+		if ( graph->edges_neighbours[u] > stats->max_degree ) stats->max_degree = graph->edges_neighbours[u];
+	}
+	stats->average_degree = n > 0 ? (double) neighbours / n : 0;
+	stats->skew = stats->average_degree > 0 ? stats->max_degree / stats->average_degree : 0;
+
+	if ( graph->flag != DIRECTED ) return;
+
+	in = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+	level = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+	queue = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+	amount = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) in[graph->edges_index[u][k]]++;
+	}
+	for ( int u = 0; u < n; u++ ) {
+		if ( in[u] == 0 ) queue[tail++] = u;
+	}
+
+	// A vertex is one level below its deepest predecessor
+	while ( head < tail ) {
+		int	u = queue[head++];
+
+		amount[level[u]]++;
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			int	v = graph->edges_index[u][k];
+
+			if ( level[u] + 1 > level[v] ) level[v] = level[u] + 1;
+			if ( --in[v] == 0 ) queue[tail++] = v;
+		}
+	}
+
+	// Vertices that never lost all their predecessors are on a cycle
+	if ( tail == n ) {
+		stats->acyclic = 1;
+		stats->depth = 0;
+		stats->width = 0;
+		for ( int l = 0; l < n && amount[l] > 0; l++ ) {
+			stats->depth = l + 1;
+			if ( amount[l] > stats->width ) stats->width = amount[l];
+		}
+	}
+
+	mem_free(in);
+	mem_free(level);
+	mem_free(queue);
+	mem_free(amount);
+}
+
+/**
+ * @brief Prints the statistics of a graph
+ */
+void stats_print(GraphStats* stats) {
+	printf("\nStatistics: %d vertices, %d edges, density %.4f, degree max %d average %.2f skew %.2f",
+	       stats->vertices, stats->edges, stats->density, stats->max_degree, stats->average_degree, stats->skew);
+	if ( stats->acyclic ) {
+		printf(", acyclic with depth %d and width at least %d\n", stats->depth, stats->width);
+	} else {
+		printf(", not a directed acyclic graph\n");
+	}
+}
+
+/**
+ * @brief Chooses the engine and the closure representation of a graph
+ *
+ * @param graph Graph about to be reduced, its closure_storage is set
+ * @param stats Statistics of graph, see stats_compute
+ * @param requested Engine asked for, STATS_ENGINE_AUTO to let the statistics decide
+ *
+ * @details walk() is always preferred: permutation() tries every ordering of
+ *          the vertices and is only run when asked for. Acyclic graphs whose
+ *          levels are at most chain_max_width wide go to the chain engine,
+ *          which still falls back to the closure engines if the decomposition
+ *          turns out wider. Unless stats_storage forces one, the closure is
+ *          kept compressed when dense rows would take more than
+ *          stats_dense_bytes on a graph below CLOSURE_DENSE_THRESHOLD.
+ *          The decision and its reason are printed.
+ *
+ * @returns Engine to run, one of the STATS_ENGINE_* values other than STATS_ENGINE_AUTO
+ */
+int stats_select(Graph* graph, GraphStats* stats, int requested) {
+	int		engine = requested;
+	const char	*reason = "asked for";
+	double		dense_bytes = (double) stats->vertices * stats->vertices / 8;
+
+	if ( engine == STATS_ENGINE_AUTO ) {
+		if ( stats->acyclic && chain_max_width != CHAIN_DISABLED && stats->width <= chain_max_width ) {
+			engine = STATS_ENGINE_CHAIN;
+			reason = "acyclic and narrow";
+		} else {
+			engine = STATS_ENGINE_WALK;
+			reason = stats->acyclic ? "acyclic but wide" : "not a directed acyclic graph";
+		}
+	} else if ( engine == STATS_ENGINE_CHAIN && ! stats->acyclic ) {
+		printf("WARNING: The chain engine needs a directed acyclic graph, walk is used instead\n");
+		engine = STATS_ENGINE_WALK;
+		reason = "chain asked for on a graph that is not a directed acyclic graph";
+	} else if ( engine == STATS_ENGINE_PERMUTATION && stats->vertices >= STATS_PERMUTATION_LIMIT ) {
+		printf("WARNING: Permutation tries every ordering of the %d vertices and may never finish\n", stats->vertices);
+	}
+
+	// walk() takes the chain engine only when it is chosen, whatever the width
+	if ( engine == STATS_ENGINE_WALK ) chain_max_width = CHAIN_DISABLED;
+	if ( engine == STATS_ENGINE_CHAIN && requested == STATS_ENGINE_CHAIN ) chain_max_width = stats->vertices;
+
+	if ( stats_storage != STATS_STORAGE_AUTO ) {
+		graph->closure_storage = stats_storage;
+	} else {
+		graph->closure_storage = dense_bytes > stats_dense_bytes && stats->density < CLOSURE_DENSE_THRESHOLD ? CLOSURE_COMPRESSED : CLOSURE_DENSE;
+	}
+
+	printf("Engine: %s (%s), closure %s%s\n", stats_engine_name(engine), reason,
+	       graph->closure_storage == CLOSURE_COMPRESSED ? "compressed" : graph->closure_storage == CLOSURE_LAZY ? "lazy" : "dense", stats_storage != STATS_STORAGE_AUTO ? " (asked for)" : "");
+	return engine;
+}
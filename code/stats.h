@@ -0,0 +1,77 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/stats.h
+ *
+ * @brief Struct of the statistics of a graph and of the engine chosen from them
+ *
+ */
+#ifndef STATS_H_
+#define STATS_H_
+
+	/**
+	 * @name Stats definitions
+	 */
+	/**@{*/
+	#define STATS_ENGINE_AUTO		0		/* Engine picked from the statistics */
+	#define STATS_ENGINE_WALK		1		/* walk() through closure rows or edge by edge */
+	#define STATS_ENGINE_CHAIN		2		/* walk() through a chain decomposition, acyclic graphs only */
+	#define STATS_ENGINE_PERMUTATION	3		/* permutation(), tiny graphs only */
+	#define STATS_PERMUTATION_LIMIT		10		/* Vertices from which permutation() may never finish */
+	#define STATS_DENSE_CLOSURE_BYTES	( 16L << 10 )	/* Default of stats_dense_bytes, the dense rows of 362 vertices */
+	#define STATS_STORAGE_AUTO		-1		/* Closure storage picked from the statistics */
+	/**@}*/
+
+	typedef struct GraphStats {
+
+		/**
+		 * @name Size of the graph
+		 */
+		/**@{*/
+		int	vertices;		/* Number of vertices */
+		int	edges;			/* Number of edges */
+		double	density;		/* See graph_density */
+		/**@}*/
+
+		/**
+		 * @name Degrees, counted on the lists of neighbours
+		 */
+		/**@{*/
+		int	max_degree;		/* Largest list of neighbours */
+		double	average_degree;		/* Neighbours listed per vertex */
+		double	skew;			/* max_degree over average_degree, 0 without edges */
+		/**@}*/
+
+		/**
+		 * @name Shape of a directed acyclic graph
+		 */
+		/**@{*/
+		int	acyclic;		/* 1 for a directed acyclic graph */
+		int	depth;			/* Vertices on its longest path, -1 unless acyclic */
+		int	width;			/* Largest set of vertices at the same depth, a lower bound of its width, -1 unless acyclic */
+		/**@}*/
+
+	} GraphStats;
+
+	extern int stats_engine;	/* Engine asked for on the command line, STATS_ENGINE_AUTO by default */
+	extern int stats_storage;	/* Closure storage asked for on the command line, STATS_STORAGE_AUTO by default */
+	extern long stats_dense_bytes;	/* Dense closure rows kept below this size, STATS_DENSE_CLOSURE_BYTES by default */
+
+#endif /* STATS_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Stats operations
+ */
+/**@{*/
+extern int  stats_engine_parse(const char* name);
+extern const char* stats_engine_name(int engine);
+extern int  stats_storage_parse(const char* name);
+extern void stats_compute(Graph* graph, GraphStats* stats);
+extern void stats_print(GraphStats* stats);
+extern int  stats_select(Graph* graph, GraphStats* stats, int requested);
+/**@}*/
@@ -0,0 +1,172 @@
+#include "graph.h"
+#include "subgraph.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char*	subgraph_roots = NULL;
+int		subgraph_direction = SUBGRAPH_DESCENDANTS;
+
+/**
+ * @brief Direction given its name on the command line
+ *
+ * @returns One of the SUBGRAPH_* directions, -1 (ERROR) if the name is unknown
+ */
+int subgraph_parse(const char* name) {
+	if ( strcmp(name, "descendants") == 0 ) return SUBGRAPH_DESCENDANTS;
+	if ( strcmp(name, "ancestors") == 0 ) return SUBGRAPH_ANCESTORS;
+	if ( strcmp(name, "induced") == 0 ) return SUBGRAPH_INDUCED;
+
+	printf("ERROR: Unknown subgraph direction (%s), expected descendants, ancestors or induced\n", name);
+	return -1;
+}
+
+/**
+ * @brief Positions of the roots named in a list
+ *
+ * @param graph Graph holding the roots
+ * @param names Names separated by SUBGRAPH_SEPARATOR
+ * @param amount Receives the number of roots
+ *
+ * @returns Array of positions to be freed by the caller, NULL (ERROR) if a name is not a vertex
+ */
+int* subgraph_find_roots(Graph* graph, const char* names, int* amount) {
+	char	*copy = (char*) mem_malloc( strlen(names) + 1, MEM_SCRATCH ),
+		*token = NULL,
+		*saved = NULL;
+	int	*roots = (int*) mem_malloc( sizeof(int) * ( strlen(names) / 2 + 1 ), MEM_SCRATCH );
+
+	strcpy(copy, names);
+	*amount = 0;
+	for ( token = strtok_r(copy, SUBGRAPH_SEPARATOR, &saved); token != NULL; token = strtok_r(NULL, SUBGRAPH_SEPARATOR, &saved) ) {
+		if ( ( roots[*amount] = graph_vertice_finder(graph, token) ) == -1 ) {
+			printf("ERROR: The root (%s) was not found in your graph.\n", token);
+			mem_free(copy);
+			mem_free(roots);
+			return NULL;
+		}
+		( *amount )++;
+	}
+
+	mem_free(copy);
+	return roots;
+}
+
+/**
+ * @brief Orders positions increasingly, for qsort
+ */
+int subgraph_compare(const void* first, const void* second) {
+	return *(const int*) first - *(const int*) second;
+}
+
+/**
+ * @brief Copy of the region of a graph around some roots
+ *
+ * @param graph Graph to be iterated
+ * @param roots Positions of the roots
+ * @param amount Number of roots
+ * @param direction SUBGRAPH_DESCENDANTS, SUBGRAPH_ANCESTORS or SUBGRAPH_INDUCED
+ *
+ * @details A single breadth-first search from the roots collects the region,
+ *          following the lists of neighbours for descendants. Lists of
+ *          predecessors are not stored, so for ancestors they are built first
+ *          by one counting pass over the edges. The vertices of the region
+ *          keep their relative order and every edge between two of them is
+ *          copied, so the reduction of the copy only costs what the region
+ *          holds. On a non-directed graph ancestors and descendants are both
+ *          the components of the roots.
+ *
+ * @returns Reference to newly create Graph, NULL on ERROR
+ */
+Graph* subgraph_extract(Graph* graph, const int* roots, int amount, int direction) {
+	int	n = graph->vertices_amount,
+		size = 0,
+		edges = 0;
+	int	*label = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*region = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ),
+		*offsets = NULL,
+		*predecessors = NULL,
+		*sources = NULL,
+		*destinations = NULL;
+	Graph	*sub = NULL;
+
+	for ( int v = 0; v < n; v++ ) label[v] = -1;
+
+	for ( int i = 0; i < amount; i++ ) {
+		if ( label[roots[i]] == -1 ) {
+			label[roots[i]] = 0;
+			region[size++] = roots[i];
+		}
+	}
+
+	// Predecessors of every vertex, grouped by vertex as in a list of neighbours
+	if ( direction == SUBGRAPH_ANCESTORS && graph->flag == DIRECTED ) {
+		offsets = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH );
+		predecessors = (int*) mem_malloc( sizeof(int) * graph->edges_amount + 1, MEM_SCRATCH );
+
+		for ( int u = 0; u < n; u++ ) {
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) offsets[graph->edges_index[u][k] + 1]++;
+		}
+		for ( int v = 0; v < n; v++ ) offsets[v + 1] += offsets[v];
+		for ( int u = 0; u < n; u++ ) {
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) predecessors[offsets[graph->edges_index[u][k]]++] = u;
+		}
+		for ( int v = n; v > 0; v-- ) offsets[v] = offsets[v - 1];
+		offsets[0] = 0;
+	}
+
+	// The region is its own queue
+	for ( int head = 0; head < size && direction != SUBGRAPH_INDUCED; head++ ) {
+		int	u = region[head],
+			first = predecessors != NULL ? offsets[u] : 0,
+			last = predecessors != NULL ? offsets[u + 1] : graph->edges_neighbours[u];
+
+		for ( int k = first; k < last; k++ ) {
+			int	v = predecessors != NULL ? predecessors[k] : graph->edges_index[u][k];
+
+			if ( label[v] == -1 ) {
+				label[v] = 0;
+				region[size++] = v;
+			}
+		}
+	}
+
+	qsort(region, size, sizeof(int), subgraph_compare);
+	for ( int p = 0; p < size; p++ ) {
+		label[region[p]] = p;
+		edges += graph->edges_neighbours[region[p]];
+	}
+
+	sources = (int*) mem_malloc( sizeof(int) * edges + 1, MEM_SCRATCH );
+	destinations = (int*) mem_malloc( sizeof(int) * edges + 1, MEM_SCRATCH );
+	edges = 0;
+	for ( int p = 0; p < size; p++ ) {
+		int	u = region[p];
+
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			int	v = graph->edges_index[u][k];
+
+			// A non-directed edge is stored on both vertices but inserted once
+			if ( label[v] == -1 || ( graph->flag == NON_DIRECTED && v < u ) ) continue;
+
+			sources[edges] = p;
+			destinations[edges] = label[v];
+			edges++;
+		}
+	}
+
+	if ( ( sub = graph_initializer(size > 0 ? size : 1, edges > 0 ? edges : 1, graph->flag) ) != NULL ) {
+		sub->closure_storage = graph->closure_storage;
+		for ( int p = 0; p < size; p++ ) graph_add_vertice(sub, graph->vertices[region[p]]);
+		graph_add_edges(sub, sources, destinations, edges);
+	}
+
+	mem_free(label);
+	mem_free(region);
+	mem_free(offsets);
+	mem_free(predecessors);
+	mem_free(sources);
+	mem_free(destinations);
+	return sub;
+}
@@ -0,0 +1,39 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/subgraph.h
+ *
+ * @brief Definitions of the regions of a graph that can be reduced on their own
+ *
+ */
+#ifndef SUBGRAPH_H_
+#define SUBGRAPH_H_
+
+	/**
+	 * @name Subgraph definitions
+	 */
+	/**@{*/
+	#define SUBGRAPH_DESCENDANTS	0		/* Roots and every vertex they reach */
+	#define SUBGRAPH_ANCESTORS	1		/* Roots and every vertex reaching them */
+	#define SUBGRAPH_INDUCED	2		/* Roots only, with the edges between them */
+	#define SUBGRAPH_SEPARATOR	","		/* Separates the roots given on the command line */
+	/**@}*/
+
+	extern const char* subgraph_roots;	/* Roots given on the command line, NULL for the whole graph */
+	extern int	   subgraph_direction;	/* Region kept around the roots, SUBGRAPH_DESCENDANTS by default */
+
+#endif /* SUBGRAPH_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Subgraph operations
+ */
+/**@{*/
+extern int    subgraph_parse(const char* name);
+extern int*   subgraph_find_roots(Graph* graph, const char* names, int* amount);
+extern Graph* subgraph_extract(Graph* graph, const int* roots, int amount, int direction);
+/**@}*/
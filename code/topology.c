@@ -0,0 +1,158 @@
+#include "graph.h"
+#include "bitset.h"
+#include "walk.h"
+#include "overlay.h"
+#include "checkpoint.h"
+#include "witness.h"
+#include "topology.h"
+#include "memtrack.h"
+#include "hugealloc.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+  /***** ================== ****/
+ /***** DIRECTED KERNELS *****/
+/***** ================== ****/
+
+#define TOPOLOGY_DIRECTED	1
+
+#define TOPOLOGY_ID		uint16_t
+#define TOPOLOGY_NAME(name)	directed_narrow_##name
+#include "topology_kernels.h"
+#undef TOPOLOGY_ID
+#undef TOPOLOGY_NAME
+
+#define TOPOLOGY_ID		uint32_t
+#define TOPOLOGY_NAME(name)	directed_wide_##name
+#include "topology_kernels.h"
+#undef TOPOLOGY_ID
+#undef TOPOLOGY_NAME
+
+#undef TOPOLOGY_DIRECTED
+
+  /***** ====================== ****/
+ /***** NON-DIRECTED KERNELS *****/
+/***** ====================== ****/
+
+#define TOPOLOGY_DIRECTED	0
+
+#define TOPOLOGY_ID		uint16_t
+#define TOPOLOGY_NAME(name)	undirected_narrow_##name
+#include "topology_kernels.h"
+#undef TOPOLOGY_ID
+#undef TOPOLOGY_NAME
+
+#define TOPOLOGY_ID		uint32_t
+#define TOPOLOGY_NAME(name)	undirected_wide_##name
+#include "topology_kernels.h"
+#undef TOPOLOGY_ID
+#undef TOPOLOGY_NAME
+
+#undef TOPOLOGY_DIRECTED
+
+/**
+ * @brief Kernels of every specialisation, by direction then width
+ */
+static TopologyKernels topology_table[2][2] = {
+	{ { undirected_narrow_closure, undirected_narrow_reduce }, { undirected_wide_closure, undirected_wide_reduce } },
+	{ { directed_narrow_closure, directed_narrow_reduce }, { directed_wide_closure, directed_wide_reduce } }
+};
+
+/**
+ * @brief Builds the compact adjacency of a view
+ *
+ * @param view View to be read, it must not have edges missing from its base graph
+ *
+ * @details Every entry of the lists of the base graph is kept, in the same
+ *          order, those deleted by the view being marked removed. Graphs of up
+ *          to TOPOLOGY_NARROW_LIMIT vertices store their IDs in 16 bits.
+ *
+ * @returns Reference to newly create Topology, NULL if the view has added edges
+ */
+Topology* topology_build(Overlay* view) {
+	Graph		*graph = view->base;
+	Topology	*topology = NULL;
+	int		n = graph->vertices_amount;
+
+	// Added edges are not in the lists of the base graph
+	if ( view->added.amount > 0 ) return NULL;
+
+	topology = (Topology*) mem_malloc( sizeof(Topology), MEM_SCRATCH );
+	topology->vertices = n;
+	topology->flag = graph->flag;
+	topology->width = n <= TOPOLOGY_NARROW_LIMIT ? TOPOLOGY_NARROW : TOPOLOGY_WIDE;
+	topology->offsets = (long*) huge_calloc( n + 1, sizeof(long), MEM_SCRATCH );
+
+	topology->offsets[0] = 0;
+	for ( int u = 0; u < n; u++ ) topology->offsets[u + 1] = topology->offsets[u] + graph->edges_neighbours[u];
+	topology->entries = topology->offsets[n];
+
+	topology->targets = huge_calloc( topology->entries + 1, topology->width == TOPOLOGY_NARROW ? sizeof(uint16_t) : sizeof(uint32_t), MEM_SCRATCH );
+	topology->removed = (unsigned char*) huge_calloc( topology->entries + 1, sizeof(unsigned char), MEM_SCRATCH );
+
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			long	e = topology->offsets[u] + k;
+			int	v = graph->edges_index[u][k];
+
+			if ( topology->width == TOPOLOGY_NARROW ) {
+				( (uint16_t*) topology->targets )[e] = (uint16_t) v;
+			} else {
+				( (uint32_t*) topology->targets )[e] = (uint32_t) v;
+			}
+
+			if ( view->deleted.amount > 0 && edgeset_contains(&view->deleted, overlay_key(view, u, v)) ) topology->removed[e] = 1;
+		}
+	}
+
+	return topology;
+}
+
+/**
+ * @brief Frees a Topology
+ */
+void topology_destroy(Topology* topology) {
+	if ( topology == NULL ) return;
+
+	huge_free(topology->offsets);
+	huge_free(topology->targets);
+	huge_free(topology->removed);
+	mem_free(topology);
+}
+
+/**
+ * @brief Kernels specialised for a Topology
+ *
+ * @details The only place where the direction and the width are looked at,
+ *          the kernels themselves have no branch on them.
+ */
+TopologyKernels* topology_kernels(Topology* topology) {
+	return &topology_table[topology->flag == DIRECTED][topology->width];
+}
+
+/**
+ * @brief Transitive closure of the entries kept
+ *
+ * @param topology Adjacency to be iterated
+ *
+ * @returns Matrix with row i column j set if j is reachable from i
+ */
+BitMatrix* topology_closure(Topology* topology) {
+	BitMatrix	*closure = bitmatrix_initializer(topology->vertices);
+
+	topology_kernels(topology)->closure(topology, closure);
+	return closure;
+}
+
+/**
+ * @brief Removes the redundant edges of a view one by one
+ *
+ * @param topology Adjacency built from view
+ * @param view View that will have its redundant edges removed
+ * @param progress Budget and progress of the reduction, NULL for none
+ */
+void topology_reduce(Topology* topology, Overlay* view, WalkProgress* progress) {
+	topology_kernels(topology)->reduce(topology, view, progress);
+}
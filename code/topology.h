@@ -0,0 +1,77 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/topology.h
+ *
+ * @brief Struct of a compact adjacency of a view, read by kernels specialised on
+ *        the direction of the graph and on the width of its vertex IDs
+ *
+ */
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+	/**
+	 * @name Topology definitions
+	 */
+	/**@{*/
+	#define TOPOLOGY_NARROW_LIMIT	65536		/* Vertices whose IDs fit in 16 bits */
+	#define TOPOLOGY_NARROW		0		/* Vertex IDs stored as uint16_t */
+	#define TOPOLOGY_WIDE		1		/* Vertex IDs stored as uint32_t */
+	/**@}*/
+
+	struct Overlay;			/* Copy-on-write view of a graph, see overlay.h */
+	struct BitMatrix;		/* Rows of bits, see bitset.h */
+	struct WalkProgress;		/* Budget and progress of a reduction, see walk.h */
+
+	typedef struct Topology {
+
+		/**
+		 * @name Shape of the graph, fixed by topology_build
+		 */
+		/**@{*/
+		int	vertices;		/* Vertices of the base graph */
+		int	flag;			/* DIRECTED or NON_DIRECTED */
+		int	width;			/* TOPOLOGY_NARROW or TOPOLOGY_WIDE */
+		long	entries;		/* Neighbours listed, both directions of a non-directed edge */
+		/**@}*/
+
+		/**
+		 * @name Neighbours of the base graph, in the order of its lists
+		 */
+		/**@{*/
+		long*		offsets;	/* First entry of each vertex, vertices + 1 of them */
+		void*		targets;	/* Neighbour of each entry, uint16_t or uint32_t after width */
+		unsigned char*	removed;	/* 1 for the entries that are not in the view */
+		/**@}*/
+
+	} Topology;
+
+	typedef struct TopologyKernels {
+
+		/**
+		 * @name Operations compiled once for each direction and width
+		 */
+		/**@{*/
+		void	(*closure)(Topology* topology, struct BitMatrix* closure);				/* Fills the closure rows */
+		void	(*reduce)(Topology* topology, struct Overlay* view, struct WalkProgress* progress);	/* Removes the redundant edges one by one */
+		/**@}*/
+
+	} TopologyKernels;
+
+#endif /* TOPOLOGY_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Topology operations
+ */
+/**@{*/
+extern Topology* topology_build(struct Overlay* view);
+extern void topology_destroy(Topology* topology);
+extern TopologyKernels* topology_kernels(Topology* topology);
+extern struct BitMatrix* topology_closure(Topology* topology);
+extern void topology_reduce(Topology* topology, struct Overlay* view, struct WalkProgress* progress);
+/**@}*/
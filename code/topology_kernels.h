@@ -0,0 +1,220 @@
+/**
+ * @file Transitive-Reduction/topology_kernels.h
+ *
+ * @brief Kernels of a Topology, included by topology.c once per specialisation
+ *
+ * @details Not a regular header, it has no include guard. Before each inclusion
+ *          topology.c defines:
+ *          TOPOLOGY_ID		type of a vertex ID, uint16_t or uint32_t
+ *          TOPOLOGY_DIRECTED	1 for directed graphs, 0 for non-directed ones
+ *          TOPOLOGY_NAME(name)	name of a kernel of this specialisation
+ *          so the direction is known at compile time and the inner loops read
+ *          IDs of the smallest width that holds every vertex.
+ */
+
+/**
+ * @brief Checks if destination is reachable from source through the entries kept
+ *
+ * @param queue Room for every vertex
+ * @param seen Stamp of the search that last reached each vertex
+ * @param stamp Stamp of this search, never used before
+ * @param parent Receives the vertex each vertex was reached from, NULL if not needed
+ *
+ * @returns 1 if reachable, otherwise 0
+ */
+static int TOPOLOGY_NAME(reach)(Topology* topology, int source, int destination, TOPOLOGY_ID* queue, int* seen, int stamp, int* parent) {
+	const TOPOLOGY_ID	*targets = (const TOPOLOGY_ID*) topology->targets;
+	const long		*offsets = topology->offsets;
+	const unsigned char	*removed = topology->removed;
+	int	head = 0,
+		tail = 0;
+
+	queue[tail++] = (TOPOLOGY_ID) source;
+	seen[source] = stamp;
+	while ( head < tail ) {
+		int	u = queue[head++];
+
+		for ( long e = offsets[u]; e < offsets[u + 1]; e++ ) {
+			int	v = targets[e];
+
+			if ( removed[e] || seen[v] == stamp ) continue;
+			if ( parent != NULL ) parent[v] = u;
+			if ( v == destination ) return 1;
+
+			seen[v] = stamp;
+			queue[tail++] = (TOPOLOGY_ID) v;
+		}
+	}
+
+	return 0;
+}
+
+#if ! TOPOLOGY_DIRECTED
+/**
+ * @brief Entry of the edge source -> destination, -1 if there is none
+ *
+ * @details Bisection, the entries of a vertex are sorted as its list of
+ *          neighbours. Used to find the other direction of a non-directed edge.
+ */
+static long TOPOLOGY_NAME(entry)(Topology* topology, int source, int destination) {
+	const TOPOLOGY_ID	*targets = (const TOPOLOGY_ID*) topology->targets;
+	long	low = topology->offsets[source],
+		high = topology->offsets[source + 1] - 1;
+
+	while ( low <= high ) {
+		long	middle = low + ( high - low ) / 2;
+		int	target = targets[middle];
+
+		if ( target == destination ) return middle;
+
+		if ( target < destination ) {
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+
+	return -1;
+}
+#endif
+
+/**
+ * @brief Closure rows of the entries kept, a vertex is not part of its own row
+ *
+ * @details Directed graphs search from every vertex, as overlay_closure does.
+ *          On a non-directed graph every vertex reaches its whole component,
+ *          so each component is searched once and its row copied to its members.
+ */
+static void TOPOLOGY_NAME(closure)(Topology* topology, BitMatrix* closure) {
+	const TOPOLOGY_ID	*targets = (const TOPOLOGY_ID*) topology->targets;
+	const long		*offsets = topology->offsets;
+	const unsigned char	*removed = topology->removed;
+	int	n = topology->vertices;
+	TOPOLOGY_ID	*stack = (TOPOLOGY_ID*) mem_malloc( sizeof(TOPOLOGY_ID) * n + 1, MEM_SCRATCH );
+
+#if TOPOLOGY_DIRECTED
+	for ( int i = 0; i < n; i++ ) {
+		WORD	*row = bitmatrix_row(closure, i);
+		int	top = -1;
+
+		stack[++top] = (TOPOLOGY_ID) i;
+		while ( top >= 0 ) {
+			int	u = stack[top--];
+
+			for ( long e = offsets[u]; e < offsets[u + 1]; e++ ) {
+				int	v = targets[e];
+
+				if ( removed[e] || v == i || ( ( row[v / WORD_BITS] >> ( v % WORD_BITS ) ) & 1 ) ) continue;
+
+				row[v / WORD_BITS] |= (WORD) 1 << ( v % WORD_BITS );
+				stack[++top] = (TOPOLOGY_ID) v;
+			}
+		}
+	}
+#else
+	int	*component = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+
+	for ( int i = 0; i < n; i++ ) component[i] = -1;
+
+	// The stack ends up holding the members of the component, in the order they were found
+	for ( int s = 0; s < n; s++ ) {
+		WORD	*row = bitmatrix_row(closure, s);
+		int	head = 0,
+			tail = 0;
+
+		if ( component[s] != -1 ) continue;
+
+		component[s] = s;
+		stack[tail++] = (TOPOLOGY_ID) s;
+		while ( head < tail ) {
+			int	u = stack[head++];
+
+			for ( long e = offsets[u]; e < offsets[u + 1]; e++ ) {
+				int	v = targets[e];
+
+				if ( removed[e] || component[v] != -1 ) continue;
+
+				component[v] = s;
+				stack[tail++] = (TOPOLOGY_ID) v;
+			}
+		}
+
+		if ( tail == 1 ) continue;
+
+		for ( int k = 0; k < tail; k++ ) row[stack[k] / WORD_BITS] |= (WORD) 1 << ( stack[k] % WORD_BITS );
+		for ( int k = 1; k < tail; k++ ) {
+			WORD	*member = bitmatrix_row(closure, stack[k]);
+
+			memcpy(member, row, sizeof(WORD) * closure->words_per_row);
+			member[stack[k] / WORD_BITS] &= ~( (WORD) 1 << ( stack[k] % WORD_BITS ) );
+		}
+		row[s / WORD_BITS] &= ~( (WORD) 1 << ( s % WORD_BITS ) );
+	}
+
+	mem_free(component);
+#endif
+
+	mem_free(stack);
+}
+
+/**
+ * @brief Removes the redundant edges of the view one by one, in the order of the base graph
+ *
+ * @details Same edges, order, checkpoint cursor and budget as walk_edges. The
+ *          closure of a graph is left unchanged by removing u -> v exactly when
+ *          v is still reachable from u, as every path through the edge can go
+ *          around it, so each test is a single search that stops at v instead
+ *          of the comparison of two closures. A non-directed edge is tested
+ *          once, from its first vertex, and removed in both directions. With a
+ *          witness file, the search also keeps the parent of every vertex it
+ *          reaches, and the path it found is written for each edge removed.
+ */
+static void TOPOLOGY_NAME(reduce)(Topology* topology, Overlay* view, WalkProgress* progress) {
+	const TOPOLOGY_ID	*targets = (const TOPOLOGY_ID*) topology->targets;
+	int	n = topology->vertices,
+		stamp = 0,
+		stopped = 0;
+	long	resume = checkpoint_resume(view->checkpoint);
+	TOPOLOGY_ID	*queue = (TOPOLOGY_ID*) mem_malloc( sizeof(TOPOLOGY_ID) * n + 1, MEM_SCRATCH );
+	int	*seen = (int*) mem_calloc( n + 1, sizeof(int), MEM_SCRATCH ),
+		*parent = view->witness != NULL ? (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH ) : NULL;
+
+	// Entries are numbered as the edges of the base graph, which is what the checkpoint cursor counts
+	for ( int u = 0; u < n && ! stopped; u++ ) {
+		for ( long e = topology->offsets[u]; e < topology->offsets[u + 1] && ! stopped; e++ ) {
+			int	v = targets[e],
+				removed = 1;
+
+			if ( e < resume || topology->removed[e] ) continue;
+#if ! TOPOLOGY_DIRECTED
+			if ( v < u ) continue;
+
+			long	mirror = TOPOLOGY_NAME(entry)(topology, v, u);
+
+			topology->removed[mirror] = 1;
+#endif
+			topology->removed[e] = 1;
+
+			if ( u != v && ! TOPOLOGY_NAME(reach)(topology, u, v, queue, seen, ++stamp, parent) ) {
+				// The edge is the only way from u to v, it goes back to where it was
+				topology->removed[e] = 0;
+#if ! TOPOLOGY_DIRECTED
+				topology->removed[mirror] = 0;
+#endif
+				removed = 0;
+			} else {
+				overlay_delete_edge(view, u, v);
+				checkpoint_removed(view->checkpoint, u, v);
+				// A loop is redundant without any path
+				if ( u != v ) witness_removed(view->witness, parent, u, v);
+			}
+
+			checkpoint_cursor(view->checkpoint, e + 1);
+			stopped = walk_progress_step(progress, 1, removed);
+		}
+	}
+
+	mem_free(queue);
+	mem_free(seen);
+	mem_free(parent);
+}
@@ -1,9 +1,23 @@
 #include "graph.h"
 #include "stack.h"
+#include "bitset.h"
 #include "walk.h"
+#include "kernels.h"
+#include "roaring.h"
+#include "overlay.h"
+#include "external.h"
+#include "wavefront.h"
+#include "shard.h"
+#include "topology.h"
+#include "chain.h"
+#include "checkpoint.h"
+#include "witness.h"
+#include "memtrack.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <time.h>
 
 
 /**
@@ -11,91 +25,384 @@
  *
  * @param graph Graph to be iterated
  *
- * @details Receives two graphs and compare its transitive closures
+ * @details Receives two graphs and compare its transitive closures. When both
+ *          closures have bit rows of the same width, or compressed rows, they
+ *          are compared row by row, otherwise only the sizes of the closures
+ *          are compared.
  *
  * @returns IF EQUALS, return 1 
  * 	        OTHERWISE, return 0
  */
 int isEqual(Graph* original, Graph* modified){
     int	i = 0; 
+    int by_rows = original->closure_rows != NULL && modified->closure_rows != NULL &&
+                  original->closure_rows->words_per_row == modified->closure_rows->words_per_row;
+    int by_compressed = original->closure_compressed != NULL && modified->closure_compressed != NULL;
 
     for (; i < original->vertices_amount ; i++) {
         if(original->num_transitive_closure[i] != modified->num_transitive_closure[i]) return 0;
+
+        if (by_compressed && ! roaring_equal(original->closure_compressed[i], modified->closure_compressed[i])) return 0;
+
+        if (by_rows && ! kernels.row_equal(bitmatrix_row(original->closure_rows, i), bitmatrix_row(modified->closure_rows, i), original->closure_rows->words_per_row)) return 0;
     }
     
     return 1;
 }
 
+double walk_time_budget = WALK_UNLIMITED;
+long   walk_test_budget = WALK_UNLIMITED;
+double walk_progress_interval = WALK_PROGRESS_INTERVAL;
+
+/**
+ * @brief Monotonic time in seconds
+ */
+double walk_clock(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Starts counting the progress of a reduction
+ *
+ * @param progress Progress with its budget already set
+ * @param total Number of edges to be tested
+ */
+void walk_progress_start(WalkProgress* progress, long total) {
+    progress->total = total;
+    progress->tested = 0;
+    progress->removed = 0;
+    progress->started = walk_clock();
+    progress->reported = progress->started;
+    progress->stopped = 0;
+}
+
+/**
+ * @brief Prints how far a reduction is
+ */
+void walk_progress_report(WalkProgress* progress, double now) {
+    double elapsed = now - progress->started;
+    double remaining = progress->tested > 0 ? elapsed * ( progress->total - progress->tested ) / progress->tested : 0;
+
+    printf("PROGRESS: %ld of %ld edges tested, %ld removed, %.1fs elapsed, about %.1fs remaining\n",
+           progress->tested, progress->total, progress->removed, elapsed, remaining);
+    fflush(stdout);
+    progress->reported = now;
+}
+
+/**
+ * @brief Counts edge tests of a reduction and checks its budget
+ *
+ * @param progress Progress of the reduction, NULL when there is no budget
+ * @param tested Edges tested since the last call
+ * @param removed Edges removed since the last call
+ *
+ * @details Progress is reported every interval seconds. Edges are only
+ *          removed once proven redundant, so stopping at any call leaves a
+ *          graph with the same reachability as the original one.
+ *
+ * @returns 1 if the budget is exhausted and the reduction must stop, otherwise 0
+ */
+int walk_progress_step(WalkProgress* progress, long tested, long removed) {
+    double now = 0;
+
+    if (progress == NULL) return 0;
+
+    progress->tested += tested;
+    progress->removed += removed;
+    now = walk_clock();
+
+    if (progress->interval > 0 && now - progress->reported >= progress->interval) walk_progress_report(progress, now);
+
+    if ((progress->time_budget > WALK_UNLIMITED && now - progress->started >= progress->time_budget) ||
+        (progress->test_budget > WALK_UNLIMITED && progress->tested >= progress->test_budget)) {
+        progress->stopped = 1;
+    }
+
+    return progress->stopped;
+}
+
+/**
+ * @brief Removes the redundant edges of a directed acyclic graph given its closure rows
+ *
+ * @param view View that will have its redundant edges removed
+ * @param rows Closure row of every vertex
+ * @param words Number of WORDs of each row
+ * @param order Order in which the vertices are visited, NULL for vertex order
+ * @param progress Budget and progress of the reduction, NULL for none
+ *
+ * @details In a DAG an edge u -> v is redundant exactly when v is reachable
+ *          from another neighbour of u, and removing it does not change the
+ *          closure, so every edge can be tested against the closure of the
+ *          original graph. The neighbours of u that are inside the union of
+ *          the closure rows of all neighbours of u are removed, which gives the
+ *          same graph as removing and testing the edges one by one.
+ */
+void walk_reduce(Overlay* view, WORD** rows, int words, int* order, WalkProgress* progress) {
+    int amount = 0;
+    int removed = 0;
+    int* neighbours = (int*) mem_malloc( sizeof(int) * view->base->vertices_amount + 1, MEM_SCRATCH );
+    WORD* covered = (WORD*) mem_malloc( sizeof(WORD) * words + 1, MEM_SCRATCH );
+    WORD* kept = (WORD*) mem_malloc( sizeof(WORD) * words + 1, MEM_SCRATCH );
+
+    for( int p = (int) checkpoint_resume(view->checkpoint); p < view->base->vertices_amount ; p++ ){
+        int i = order != NULL ? order[p] : p;
+
+        amount = overlay_neighbours(view, i, neighbours);
+
+        memset(covered, 0, sizeof(WORD) * words);
+        memset(kept, 0, sizeof(WORD) * words);
+        for( int k = 0; k < amount; k++ ) {
+            kept[neighbours[k] / WORD_BITS] |= (WORD) 1 << ( neighbours[k] % WORD_BITS );
+            kernels.row_union(covered, rows[neighbours[k]], words);
+        }
+
+        // No neighbour reaches another one, every edge is kept
+        if (kernels.row_disjoint(kept, covered, words)) {
+            checkpoint_cursor(view->checkpoint, p + 1);
+            if (walk_progress_step(progress, amount, 0)) break;
+            continue;
+        }
+
+        kernels.row_difference(kept, covered, words);
+        removed = 0;
+        for( int k = 0; k < amount; k++ ) {
+            if (( ( kept[neighbours[k] / WORD_BITS] >> ( neighbours[k] % WORD_BITS ) ) & 1 ) == 0) {
+                overlay_delete_edge(view, i, neighbours[k]);
+                checkpoint_removed(view->checkpoint, i, neighbours[k]);
+                removed++;
+            }
+        }
+
+        checkpoint_cursor(view->checkpoint, p + 1);
+        if (walk_progress_step(progress, amount, removed)) break;
+    }
+
+    mem_free(neighbours);
+    mem_free(covered);
+    mem_free(kept);
+}
+
+/**
+ * @brief Transitive reduction of a directed acyclic graph from its closure rows
+ *
+ * @param view View that will have its redundant edges removed
+ * @param progress Budget and progress of the reduction, NULL for none
+ *
+ * @details The closure is computed once in memory, see walk_reduce
+ */
+void walk_acyclic(Overlay* view, WalkProgress* progress) {
+    BitMatrix* closure = overlay_closure(view);
+    WORD** rows = (WORD**) mem_malloc( sizeof(WORD*) * closure->rows + 1, MEM_SCRATCH );
+
+    for( int i = 0; i < closure->rows ; i++ ) rows[i] = bitmatrix_row(closure, i);
+    walk_reduce(view, rows, closure->words_per_row, NULL, progress);
+
+    bitmatrix_destroy(closure);
+    mem_free(rows);
+}
+
+/**
+ * @brief Transitive reduction of a directed acyclic graph whose closure does not fit in memory
+ *
+ * @param view View that will have its redundant edges removed
+ * @param path File that receives the closure, removed at the end
+ * @param budget Bytes of closure rows allowed in memory
+ * @param progress Budget and progress of the reduction, NULL for none
+ *
+ * @details The closure is written to a memory-mapped file by
+ *          external_closure_build, whose pages are handed back to the kernel
+ *          band by band. The file is then opened again by
+ *          external_closure_open, for reading only and in sequential mode, and
+ *          the vertices are reduced in the order of the file, so the rows are
+ *          streamed from disk instead of kept in memory.
+ *
+ * @returns 0 if OK, otherwise -1 (ERROR)
+ */
+int walk_external(Overlay* view, const char* path, long budget, WalkProgress* progress) {
+    ExternalClosure* closure = external_closure_build(view->base, path, budget);
+    WORD** rows = NULL;
+
+    if (closure == NULL) return -1;
+
+    external_closure_close(closure);
+    if ((closure = external_closure_open(path)) == NULL) {
+        unlink(path);
+        return -1;
+    }
+
+    rows = (WORD**) mem_malloc( sizeof(WORD*) * closure->rows + 1, MEM_SCRATCH );
+    for( int i = 0; i < closure->rows ; i++ ) rows[i] = external_closure_row(closure, i);
+    walk_reduce(view, rows, closure->words_per_row, closure->order, progress);
+
+    external_closure_close(closure);
+    unlink(path);
+    mem_free(rows);
+    return 0;
+}
+
+/**
+ * @brief Transitive reduction by removing and testing the edges one by one
+ *
+ * @param view View that will have its redundant edges removed
+ * @param progress Budget and progress of the reduction, NULL for none
+ *
+ * @details Each edge is removed from the view and the closure recomputed; if
+ *          the closure changed, the edge is inserted again. An undirected edge
+ *          is tested once, from its first vertex: an edge kept once is still
+ *          needed after later removals. Views without added edges are reduced
+ *          by the specialised kernels of topology_reduce, with the same result.
+ */
+void walk_edges(Overlay* view, WalkProgress* progress) {
+    Topology* topology = topology_build(view);
+
+    if (topology != NULL) {
+        topology_reduce(topology, view, progress);
+        topology_destroy(topology);
+        return;
+    }
+
+    Graph* graph = view->base;
+    BitMatrix* original = overlay_closure(view);
+    BitMatrix* current = NULL;
+    int stopped = 0;
+    long position = 0;
+    long resume = checkpoint_resume(view->checkpoint);
+
+    // Edges are taken in the order of the base graph, position counts them for the checkpoint
+    for( int i = 0; i < graph->vertices_amount && ! stopped ; i++ ){
+        for( int k = 0; k < graph->edges_neighbours[i] && ! stopped; k++, position++ ) {
+            int j = graph->edges_index[i][k];
+            int removed = 1;
+
+            if (position < resume || ! overlay_has_edge(view, i, j)) continue;
+            if (graph->flag == NON_DIRECTED && j < i) continue;
+
+            // Remove edge from view, the other direction too when graph is undirected
+            overlay_delete_edge(view, i, j);
+            current = overlay_closure(view);
+
+            if (bitmatrix_equal(original, current) == NON_EQUAL) {
+                // If the transitive closure is not equal to the original graph, return the edge to where it was
+                overlay_add_edge(view, i, j);
+                removed = 0;
+            } else {
+                checkpoint_removed(view->checkpoint, i, j);
+            }
+
+            bitmatrix_destroy(current);
+            checkpoint_cursor(view->checkpoint, position + 1);
+            stopped = walk_progress_step(progress, 1, removed);
+        }
+    }
+
+    bitmatrix_destroy(original);
+}
+
 /**
  * @brief Transitive redction through walking method
  *
  * @param graph Graph to be iterated
+ * @param engine Receives the name of the engine that reduced the graph, once
+ *               the options and the fallbacks below are applied; NULL if not
+ *               needed
  *
- * @details Receives a graph and iterates through to find transitive reduction
+ * @details Receives a graph and iterates through to find transitive reduction.
+ *          The edges are removed from a copy-on-write view of the graph, which
+ *          is only turned into a new graph at the end. With a time or test
+ *          budget, the reduction stops once it is exhausted and the graph
+ *          reduced so far is returned; it has the same reachability as the
+ *          original one, but may still have redundant edges. With a
+ *          checkpoint_path, the work is journaled there and resumed by a
+ *          later run on the same input. Otherwise acyclic graphs that split
+ *          into at most chain_max_width chains are reduced by chain_reduce.
+ *          With a witness_path, every edge is tested by a search, as in
+ *          walk_edges, so the path found for each edge removed can be written;
+ *          the closure engines only know that a path exists.
  * 
- * @returns Graph
+ * @returns Graph, NULL if the checkpoint can not be used
  *
  */
-Graph* walk(Graph* graph) {
-    Graph* clone_graph;
-    clone_graph = graph_clone(graph);
-    
-    int pos_non_directed = -1;
-    int pos_vertice_del_non_directed = -1;
-    STRING vertice_del = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-    STRING vertice_del_non_directed = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-    
-    for( int i = 0; i < graph->vertices_amount ; i++ ){
-		
-		int	neighbours = clone_graph->edges_neighbours[i];
-
-        for( int j = 0; j < neighbours; j++ ) {
-            // Remove edge from graph and save removed edge
-            strcpy(vertice_del, "");
-            strcpy(vertice_del, clone_graph->edges[i][0]);
-            
-
-
-            if (graph->flag == NON_DIRECTED) {
-                // Remove edge from other vertex also when graph is undirected
-                pos_non_directed = graph_vertice_finder(clone_graph, clone_graph->edges[i][0]);
-                
-                if (pos_non_directed != -1) {
-                    strcpy(vertice_del_non_directed, "");
-                    strcpy(vertice_del_non_directed, clone_graph->vertices[i]);
-                    pos_vertice_del_non_directed = graph_edge_finder(clone_graph, pos_non_directed, clone_graph->vertices[i]);
-                    free_edge(clone_graph, pos_non_directed, pos_vertice_del_non_directed);
-                }
-                
-            }
-            free_edge(clone_graph, i, 0);
-            clone_graph->edges_amount -= 1;
-
-            direct_transitive_closure(clone_graph);
-            
-            //graph_print_edges(clone_graph);
-            //graph_print_direct_transitive_closure(clone_graph);
-            
-            if (isEqual(graph, clone_graph) == NON_EQUAL) {
-                // If the transitive closure is not equal to the original graph, return the edge to where it was
-                clone_graph->edges[i][clone_graph->edges_neighbours[i]] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-                strcpy(clone_graph->edges[i][clone_graph->edges_neighbours[i]], "");
-                strcpy(clone_graph->edges[i][clone_graph->edges_neighbours[i]], vertice_del);
-                clone_graph->edges_neighbours[i]++;
-                clone_graph->edges_amount++;
-                
-                if (graph->flag == NON_DIRECTED) {
-                    clone_graph->edges[pos_non_directed][clone_graph->edges_neighbours[pos_non_directed]] = (STRING) malloc( sizeof(char) * STR_SIZE + 1 );
-                    strcpy(clone_graph->edges[pos_non_directed][clone_graph->edges_neighbours[pos_non_directed]], "");
-                    strcpy(clone_graph->edges[pos_non_directed][clone_graph->edges_neighbours[pos_non_directed]], vertice_del_non_directed);
-                    clone_graph->edges_neighbours[pos_non_directed]++;
-                }
+Graph* walk(Graph* graph, const char** engine) {
+    Overlay* view = overlay_initializer(graph);
+    Graph* reduced = NULL;
+    const char* ran = NULL;
+    WalkProgress progress;
+    int budgeted = walk_time_budget > WALK_UNLIMITED || walk_test_budget > WALK_UNLIMITED;
+
+    progress.time_budget = walk_time_budget;
+    progress.test_budget = walk_test_budget;
+    progress.interval = walk_progress_interval;
+    walk_progress_start(&progress, view->edges_amount);
+
+    long closure_bytes = (long) graph->vertices_amount * ( ( graph->vertices_amount + WORD_BITS - 1 ) / WORD_BITS ) * (long) sizeof(WORD);
+    // Witnesses come from the searches of walk_edges, whatever the shape of the graph
+    int acyclic = graph->flag == DIRECTED && ! isCyclic(graph) && witness_path == NULL;
+    int external = acyclic && closure_bytes > external_budget;
+
+    if (witness_path != NULL && (view->witness = witness_open(witness_path, graph)) == NULL) {
+        overlay_destroy(view);
+        return NULL;
+    }
+
+    // Edges removed before the last commit are removed again, the engine goes on after its cursor
+    if (checkpoint_path != NULL) {
+        view->checkpoint = checkpoint_open(checkpoint_path, ! acyclic ? CHECKPOINT_WALK_EDGES : external ? CHECKPOINT_WALK_EXTERNAL : CHECKPOINT_WALK_ACYCLIC, graph);
+        if (view->checkpoint == NULL) {
+            witness_close(view->witness);
+            overlay_destroy(view);
+            return NULL;
+        }
+        checkpoint_restore(view->checkpoint, view);
+    }
+
+    // Narrow acyclic graphs need no closure at all, see chain_reduce
+    int chained = acyclic && ! budgeted && view->checkpoint == NULL && chain_max_width != CHAIN_DISABLED &&
+                  chain_reduce(view, chain_max_width, &progress) == 0;
+
+    // Acyclic directed graphs need a single closure instead of one per edge
+    if (chained) {
+        ran = "chain";
+    } else if (acyclic) {
+        if (external && walk_external(view, external_path, external_budget, &progress) == 0) {
+            ran = "external";
+        } else {
+            if (external && view->checkpoint != NULL) {
+                // The cursor counts vertices in the order of the closure file, it means nothing here
+                checkpoint_close(view->checkpoint, 0);
+                view->checkpoint = NULL;
             }
 
-            // Release transitive closure to next iteration
-            free_direct_transitive_closure(clone_graph);
+            if (budgeted || view->checkpoint != NULL) {
+                // Only the sequential engine can stop halfway and resume
+                walk_acyclic(view, &progress);
+                ran = "acyclic";
+            } else if (shard_workers != SHARD_DISABLED && shard_reduce(view, shard_workers) == 0) {
+                ran = "shard";
+            } else {
+                wavefront_reduce(view, wavefront_threads);
+                ran = "wavefront";
+            }
         }
-	}
+    } else {
+        walk_edges(view, &progress);
+        ran = "edges";
+    }
+    if (engine != NULL) *engine = ran;
+
+    if (progress.stopped) {
+        printf("WARNING: Budget exhausted after %ld of %ld edge tests, %ld edges removed; the graph is only partially reduced\n",
+               progress.tested, progress.total, progress.removed);
+    }
+
+    // A stopped reduction keeps its checkpoint so a later run can go on
+    checkpoint_close(view->checkpoint, ! progress.stopped);
+    witness_close(view->witness);
+
+    reduced = overlay_materialise(view);
+    overlay_destroy(view);
 
-    return clone_graph;
+    return reduced;
 }
@@ -16,8 +16,41 @@
 	 */
 	/**@{*/
     #define NON_EQUAL		    0		/* Direct transitive closure is not equal*/
+	#define WALK_UNLIMITED		0		/* No budget on walk() */
+	#define WALK_PROGRESS_INTERVAL	5.0		/* Seconds between two progress reports */
 	/**@}*/
 
+	struct Overlay;		/* Copy-on-write view of a graph, see overlay.h */
+
+	typedef struct WalkProgress {
+
+		/**
+		 * @name Budget of a reduction
+		 */
+		/**@{*/
+		double	time_budget;		/* Seconds after which walk() stops, WALK_UNLIMITED for none */
+		long	test_budget;		/* Edge tests after which walk() stops, WALK_UNLIMITED for none */
+		double	interval;		/* Seconds between two progress reports, 0 for none */
+		/**@}*/
+
+		/**
+		 * @name Progress of a reduction
+		 */
+		/**@{*/
+		long	total;			/* Edges to be tested */
+		long	tested;			/* Edges tested so far */
+		long	removed;		/* Edges proven redundant and removed so far */
+		double	started;		/* Time the reduction started, in seconds */
+		double	reported;		/* Time of the last progress report */
+		int	stopped;		/* 1 once the budget is exhausted */
+		/**@}*/
+
+	} WalkProgress;
+
+	extern double walk_time_budget;		/* Seconds given to walk(), WALK_UNLIMITED for no limit */
+	extern long   walk_test_budget;		/* Edge tests given to walk(), WALK_UNLIMITED for no limit */
+	extern double walk_progress_interval;	/* Seconds between progress reports of walk(), 0 for none */
+
 	
 #endif /* STACK_H_ */
 
@@ -29,5 +62,11 @@
  */
 /**@{*/
 extern int isEqual(Graph* original, Graph* modified);
-extern Graph* walk(Graph* graph);
+extern void walk_progress_start(WalkProgress* progress, long total);
+extern int  walk_progress_step(WalkProgress* progress, long tested, long removed);
+extern void walk_reduce(struct Overlay* view, WORD** rows, int words, int* order, WalkProgress* progress);
+extern void walk_acyclic(struct Overlay* view, WalkProgress* progress);
+extern int  walk_external(struct Overlay* view, const char* path, long budget, WalkProgress* progress);
+extern void walk_edges(struct Overlay* view, WalkProgress* progress);
+extern Graph* walk(Graph* graph, const char** engine);
 /**@}*/
\ No newline at end of file
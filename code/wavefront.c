@@ -0,0 +1,169 @@
+#include "graph.h"
+#include "bitset.h"
+#include "kernels.h"
+#include "overlay.h"
+#include "wavefront.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int wavefront_threads = WAVEFRONT_AUTO;
+
+/**
+ * @brief Longest-path layering of an acyclic graph, counted from the sinks
+ *
+ * @param graph Acyclic graph to be iterated
+ * @param levels_amount Receives the number of levels
+ *
+ * @details Sinks are on level 0 and every other vertex is one level above its
+ *          highest neighbour, so all the neighbours of a vertex are on lower
+ *          levels and vertices of the same level never reach each other.
+ *
+ * @returns Level of every vertex
+ */
+int* wavefront_levels(Graph* graph, int* levels_amount) {
+	int	*order = graph_descendants_first(graph),
+		*level = (int*) mem_calloc( graph->vertices_amount + 1, sizeof(int), MEM_SCRATCH );
+
+	*levels_amount = graph->vertices_amount > 0 ? 1 : 0;
+	for ( int p = 0; p < graph->vertices_amount; p++ ) {
+		int	u = order[p];
+
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			if ( level[graph->edges_index[u][k]] + 1 > level[u] ) level[u] = level[graph->edges_index[u][k]] + 1;
+		}
+		if ( level[u] + 1 > *levels_amount ) *levels_amount = level[u] + 1;
+	}
+
+	mem_free(order);
+	return level;
+}
+
+/**
+ * @brief Computes the closure rows and keep flags of a share of each level
+ *
+ * @details The vertices of a level are split in contiguous blocks, one per
+ *          worker. A row only reads rows of lower levels, finished before the
+ *          last barrier, and every worker writes its own rows and flags, so no
+ *          locking is needed inside a level.
+ */
+void* wavefront_worker(void* argument) {
+	WavefrontWorker	*worker = (WavefrontWorker*) argument;
+	Wavefront	*w = worker->wavefront;
+	Graph		*graph = w->graph;
+	int		words = w->closure->words_per_row;
+
+	// Wait until the caller knows how many workers were created
+	pthread_mutex_lock(&w->start);
+	pthread_mutex_unlock(&w->start);
+
+	for ( int l = 0; l < w->levels_amount; l++ ) {
+		long	size = w->level_start[l + 1] - w->level_start[l];
+		int	first = w->level_start[l] + (int) ( size * worker->id / w->threads ),
+			last = w->level_start[l] + (int) ( size * ( worker->id + 1 ) / w->threads );
+
+		for ( int p = first; p < last; p++ ) {
+			int	u = w->order[p];
+			WORD	*row = bitmatrix_row(w->closure, u);
+			char	*keep = w->keep + w->edge_start[u];
+
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+				kernels.row_union(row, bitmatrix_row(w->closure, graph->edges_index[u][k]), words);
+			}
+
+			// A neighbour reached through another one is a redundant edge
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+				keep[k] = ! bitmatrix_test(w->closure, u, graph->edges_index[u][k]);
+			}
+			for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+				bitmatrix_set(w->closure, u, graph->edges_index[u][k]);
+			}
+		}
+
+		if ( w->threads > 1 ) pthread_barrier_wait(&w->barrier);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Transitive reduction of a directed acyclic graph, one topological level at a time
+ *
+ * @param view View without changes yet, its redundant edges are removed
+ * @param threads Number of threads, WAVEFRONT_AUTO for one per processor
+ *
+ * @details Vertices are grouped by wavefront_levels and the levels are swept
+ *          from the sinks up, in parallel inside a level and with a barrier
+ *          between two levels. The same sweep builds the closure row of each
+ *          vertex and decides which of its edges are kept, as walk_reduce
+ *          does. The edges are read from the base graph and the removals are
+ *          applied to the view once every level is done.
+ */
+void wavefront_reduce(Overlay* view, int threads) {
+	Graph		*graph = view->base;
+	Wavefront	w;
+	WavefrontWorker	workers[WAVEFRONT_MAX_THREADS];
+	pthread_t	handles[WAVEFRONT_MAX_THREADS];
+	int		n = graph->vertices_amount,
+			created = 1;
+	int		*level = wavefront_levels(graph, &w.levels_amount);
+
+	if ( threads == WAVEFRONT_AUTO ) threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if ( threads > WAVEFRONT_MAX_THREADS ) threads = WAVEFRONT_MAX_THREADS;
+	if ( threads > n ) threads = n;
+	if ( threads < 1 ) threads = 1;
+
+	// Counting sort of the vertices by level
+	w.level_start = (int*) mem_calloc( w.levels_amount + 2, sizeof(int), MEM_SCRATCH );
+	w.order = (int*) mem_malloc( sizeof(int) * n + 1, MEM_SCRATCH );
+	w.edge_start = (int*) mem_malloc( sizeof(int) * ( n + 1 ), MEM_SCRATCH );
+	for ( int u = 0; u < n; u++ ) w.level_start[level[u] + 1]++;
+	for ( int l = 0; l < w.levels_amount; l++ ) w.level_start[l + 1] += w.level_start[l];
+	for ( int u = 0; u < n; u++ ) w.order[w.level_start[level[u]]++] = u;
+	for ( int l = w.levels_amount; l > 0; l-- ) w.level_start[l] = w.level_start[l - 1];
+	w.level_start[0] = 0;
+
+	w.edge_start[0] = 0;
+	for ( int u = 0; u < n; u++ ) w.edge_start[u + 1] = w.edge_start[u] + graph->edges_neighbours[u];
+
+	w.closure = bitmatrix_initializer(n);
+	w.keep = (char*) mem_malloc( sizeof(char) * w.edge_start[n] + 1, MEM_SCRATCH );
+	w.graph = graph;
+
+	pthread_mutex_init(&w.start, NULL);
+	pthread_mutex_lock(&w.start);
+	for ( ; created < threads; created++ ) {
+		workers[created].wavefront = &w;
+		workers[created].id = created;
+		if ( pthread_create(&handles[created], NULL, wavefront_worker, &workers[created]) != 0 ) {
+			printf("WARNING: Wavefront running with %d threads instead of %d\n", created, threads);
+			break;
+		}
+	}
+	w.threads = created;
+	if ( w.threads > 1 ) pthread_barrier_init(&w.barrier, NULL, w.threads);
+	pthread_mutex_unlock(&w.start);
+
+	workers[0].wavefront = &w;
+	workers[0].id = 0;
+	wavefront_worker(&workers[0]);
+
+	for ( int t = 1; t < w.threads; t++ ) pthread_join(handles[t], NULL);
+	if ( w.threads > 1 ) pthread_barrier_destroy(&w.barrier);
+	pthread_mutex_destroy(&w.start);
+
+	for ( int u = 0; u < n; u++ ) {
+		for ( int k = 0; k < graph->edges_neighbours[u]; k++ ) {
+			if ( ! w.keep[w.edge_start[u] + k] ) overlay_delete_edge(view, u, graph->edges_index[u][k]);
+		}
+	}
+
+	bitmatrix_destroy(w.closure);
+	mem_free(w.keep);
+	mem_free(w.level_start);
+	mem_free(w.order);
+	mem_free(w.edge_start);
+	mem_free(level);
+}
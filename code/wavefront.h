@@ -0,0 +1,83 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/wavefront.h
+ *
+ * @brief Struct of a level-synchronous reduction of a directed acyclic graph
+ *
+ */
+#ifndef WAVEFRONT_H_
+#define WAVEFRONT_H_
+
+	#include <pthread.h>
+
+	/**
+	 * @name Wavefront definitions
+	 */
+	/**@{*/
+	#define WAVEFRONT_AUTO		0		/* One thread per online processor */
+	#define WAVEFRONT_MAX_THREADS	64		/* Upper bound on the number of threads */
+	/**@}*/
+
+	struct Overlay;		/* Copy-on-write view of a graph, see overlay.h */
+
+	typedef struct Wavefront {
+
+		/**
+		 * @name Levels of the graph
+		 */
+		/**@{*/
+		int	levels_amount;		/* Number of levels */
+		int*	level_start;		/* First position in order of each level, plus one past the last */
+		int*	order;			/* Vertices sorted by level, sinks first */
+		int*	edge_start;		/* First keep flag of each vertex, see Graph::edges_index */
+		/**@}*/
+
+		/**
+		 * @name Results of the sweep
+		 */
+		/**@{*/
+		BitMatrix*	closure;	/* Closure rows, filled level by level */
+		char*		keep;		/* Keep flag of every edge of the base graph */
+		/**@}*/
+
+		/**
+		 * @name Workers
+		 */
+		/**@{*/
+		Graph*			graph;		/* Graph being reduced */
+		int			threads;	/* Number of workers, the caller included */
+		pthread_mutex_t		start;		/* Held by the caller until every worker is created */
+		pthread_barrier_t	barrier;	/* Separates two levels */
+		/**@}*/
+
+	} Wavefront;
+
+	typedef struct WavefrontWorker {
+
+		/**
+		 * @name Arguments of a worker thread
+		 */
+		/**@{*/
+		Wavefront*	wavefront;	/* Shared state of the sweep */
+		int		id;		/* Worker number, 0 is the caller */
+		/**@}*/
+
+	} WavefrontWorker;
+
+	extern int wavefront_threads;	/* Threads used by walk(), WAVEFRONT_AUTO for one per processor */
+
+#endif /* WAVEFRONT_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Wavefront operations
+ */
+/**@{*/
+extern int* wavefront_levels(Graph* graph, int* levels_amount);
+extern void wavefront_reduce(struct Overlay* view, int threads);
+/**@}*/
@@ -0,0 +1,79 @@
+#include "graph.h"
+#include "witness.h"
+#include "memtrack.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* witness_path = NULL;
+
+/**
+ * @brief Opens the side file of the witnesses of a reduction
+ *
+ * @param path File to be written, replaced if present
+ * @param graph Graph being reduced, whose names are written
+ *
+ * @returns Reference to newly create Witness, NULL (ERROR) if the file can not be written
+ */
+Witness* witness_open(const char* path, Graph* graph) {
+	Witness	*witness = NULL;
+	FILE	*file = fopen(path, "w");
+
+	if ( file == NULL ) {
+		printf("ERROR: The witness file (%s) could not be written\n", path);
+		return NULL;
+	}
+
+	witness = (Witness*) mem_malloc( sizeof(Witness), MEM_SCRATCH );
+	witness->file = file;
+	witness->graph = graph;
+	witness->written = 0;
+	return witness;
+}
+
+/**
+ * @brief Writes the path that made an edge redundant
+ *
+ * @param witness Side file, NULL for none
+ * @param parent Vertex each vertex of the path was reached from, as left by the search
+ * @param source First vertex of the edge removed, where the search started
+ * @param destination Last vertex of the edge removed, reached without it
+ *
+ * @details The search leaves a chain of parents from destination back to
+ *          source. It is reversed in place, which makes it point forward, so
+ *          the path is written from source in O(path length) and without any
+ *          memory other than parent. The parents of the search are lost.
+ *          The line is the path with its vertices joined by WITNESS_SEPARATOR,
+ *          its ends being the ends of the edge.
+ */
+void witness_removed(Witness* witness, int* parent, int source, int destination) {
+	int	previous = -1;
+
+	if ( witness == NULL ) return;
+
+	for ( int v = destination; v != source; ) {
+		int	next = parent[v];
+
+		parent[v] = previous;
+		previous = v;
+		v = next;
+	}
+
+	fputs(witness->graph->vertices[source], witness->file);
+	for ( int v = previous; v != -1; v = parent[v] ) {
+		fputc(WITNESS_SEPARATOR, witness->file);
+		fputs(witness->graph->vertices[v], witness->file);
+	}
+	fputc('\n', witness->file);
+	witness->written++;
+}
+
+/**
+ * @brief Closes the side file of the witnesses
+ */
+void witness_close(Witness* witness) {
+	if ( witness == NULL ) return;
+
+	fclose(witness->file);
+	mem_free(witness);
+}
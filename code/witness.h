@@ -0,0 +1,43 @@
+  /***** =========== ****/
+ /***** DEFINITIONS ****/
+/***** =========== ****/
+
+/**
+ * @file Transitive-Reduction/witness.h
+ *
+ * @brief Struct of the side file that receives a path for every edge removed
+ *
+ */
+#ifndef WITNESS_H_
+#define WITNESS_H_
+
+	#include <stdio.h>
+
+	/**
+	 * @name Witness definitions
+	 */
+	/**@{*/
+	#define WITNESS_SEPARATOR	'-'		/* Between two vertices of a path, as in the edges of an input */
+	/**@}*/
+
+	typedef struct Witness {
+		FILE*	 file;			/* Side file, one path per line */
+		Graph*	 graph;			/* Graph whose names are written */
+		long	 written;		/* Paths written so far */
+	} Witness;
+
+	extern const char* witness_path;	/* Side file of walk(), NULL for none */
+
+#endif /* WITNESS_H_ */
+
+  /***** =========== ****/
+ /***** PROTOTYPES *****/
+/***** =========== ****/
+/**
+ * @name Witness operations
+ */
+/**@{*/
+extern Witness* witness_open(const char* path, Graph* graph);
+extern void     witness_removed(Witness* witness, int* parent, int source, int destination);
+extern void     witness_close(Witness* witness);
+/**@}*/